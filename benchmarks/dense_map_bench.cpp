@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <dense_map.hpp>
+#include <simd.hpp>
+#include <version_vector.hpp>
+
+using namespace crdt;
+
+namespace {
+
+constexpr std::uint32_t actors = 512;
+constexpr int rounds = 20000;
+
+template <typename F> auto measure(F &&f) -> double {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; ++i)
+    f(i);
+  std::chrono::duration<double, std::nano> spent =
+      std::chrono::steady_clock::now() - start;
+  return spent.count() / rounds;
+}
+
+template <typename V> auto build(std::uint64_t shift) {
+  V v;
+  for (std::uint32_t actor = 0; actor < actors; ++actor)
+    v.dots[actor] = (actor * 7 + shift) % 13 + 1;
+  return v;
+}
+
+void report(const std::string &name, double ns) {
+  std::cout << std::left << std::setw(40) << name << std::right
+            << std::setw(12) << std::fixed << std::setprecision(1) << ns
+            << "\n";
+}
+
+template <typename V> void run(const std::string &backend) {
+  auto base = build<V>(0), other = build<V>(5);
+  volatile bool sink = false;
+
+  report(backend + " merge", measure([&](int) {
+           auto v = base;
+           v.merge(other);
+           sink = v.empty();
+         }));
+  report(backend + " dominates", measure([&](int) {
+           sink = base.dominates(other);
+         }));
+  report(backend + " reset_remove", measure([&](int) {
+           auto v = base;
+           v.reset_remove(other);
+           sink = v.empty();
+         }));
+}
+
+} // namespace
+
+auto main() -> int {
+  std::cout << actors << " actor clocks, ns per operation (copy included), "
+            << "dense kernels: " << details::simd::active().name << "\n";
+
+  run<version_vector<std::uint32_t>>("unordered_map");
+  run<dense_version_vector<std::uint32_t>>("dense_map");
+}
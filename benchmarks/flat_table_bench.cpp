@@ -0,0 +1,75 @@
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <flat_table.hpp>
+
+using namespace crdt;
+
+namespace {
+
+constexpr int keys = 1 << 16;
+constexpr int rounds = 20;
+
+template <typename F> auto measure(F &&f) -> double {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; ++i)
+    f(i);
+  std::chrono::duration<double, std::nano> spent =
+      std::chrono::steady_clock::now() - start;
+  return spent.count() / rounds / keys;
+}
+
+void report(const std::string &name, double ns) {
+  std::cout << std::left << std::setw(40) << name << std::right
+            << std::setw(12) << std::fixed << std::setprecision(1) << ns
+            << "\n";
+}
+
+template <typename M>
+void run(const std::string &backend, const std::vector<int> &order,
+         const std::string &pattern) {
+  M filled;
+  for (auto key : order)
+    filled[key] = key;
+  volatile int sink = 0;
+
+  report(backend + " insert " + pattern, measure([&](int) {
+           M m;
+           for (auto key : order)
+             m[key] = key;
+           sink = static_cast<int>(m.size());
+         }));
+  report(backend + " find " + pattern, measure([&](int) {
+           int found = 0;
+           for (auto key : order)
+             found += filled.find(key)->second;
+           sink = found;
+         }));
+}
+
+} // namespace
+
+auto main() -> int {
+  std::cout << keys << " int keys, ns per key\n";
+
+  // std::hash<int> is the identity, so sequential keys only spread over the
+  // table once the hash is mixed.
+  std::vector<int> sequential(keys);
+  for (int i = 0; i < keys; ++i)
+    sequential[i] = i;
+  std::vector<int> random(keys);
+  std::mt19937 gen(42);
+  for (auto &key : random)
+    key = static_cast<int>(gen());
+
+  run<flat_table<int, int>>("flat_table", sequential, "sequential");
+  run<flat_table<int, int>>("flat_table", random, "random");
+  run<std::unordered_map<int, int>>("unordered_map", sequential, "sequential");
+  run<std::unordered_map<int, int>>("unordered_map", random, "random");
+}
@@ -0,0 +1,80 @@
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <dot_orset.hpp>
+#include <orswot.hpp>
+
+namespace {
+
+/// Bytes currently allocated through operator new, each block counted with
+/// the header recording its size.
+std::size_t live_bytes = 0;
+
+constexpr std::size_t header = alignof(std::max_align_t);
+
+} // namespace
+
+auto operator new(std::size_t n) -> void * {
+  auto *block = static_cast<char *>(std::malloc(n + header));
+  if (block == nullptr)
+    throw std::bad_alloc();
+  *reinterpret_cast<std::size_t *>(block) = n;
+  live_bytes += n;
+  return block + header;
+}
+
+void operator delete(void *p) noexcept {
+  if (p == nullptr)
+    return;
+  auto *block = static_cast<char *>(p) - header;
+  live_bytes -= *reinterpret_cast<std::size_t *>(block);
+  std::free(block);
+}
+
+void operator delete(void *p, std::size_t) noexcept { operator delete(p); }
+
+namespace {
+
+constexpr int members = 10000;
+
+/// Heap bytes per member of a set where every member was added by the given
+/// number of writers and the replicas were then merged.
+template <typename _Set> auto bytes_per_member(int writers) -> double {
+  auto before = live_bytes;
+  auto *merged = new _Set();
+  for (int w = 0; w < writers; ++w) {
+    _Set replica;
+    auto actor = "replica-" + std::to_string(w);
+    for (int m = 0; m < members; ++m)
+      replica.add(actor, "member-" + std::to_string(m));
+    merged->merge(replica);
+  }
+  auto bytes = static_cast<double>(live_bytes - before) / members;
+  delete merged;
+  return bytes;
+}
+
+void report(const std::string &name, double bytes) {
+  std::cout << std::left << std::setw(40) << name << std::right
+            << std::setw(12) << std::fixed << std::setprecision(1) << bytes
+            << "\n";
+}
+
+} // namespace
+
+auto main() -> int {
+  std::cout << members << " string members, heap bytes per member\n";
+
+  for (int writers : {1, 3, 20}) {
+    auto suffix = " " + std::to_string(writers) + " writers";
+    report("orswot" + suffix,
+           bytes_per_member<crdt::orswot<std::string, std::string>>(writers));
+    report("dot_orset" + suffix,
+           bytes_per_member<crdt::dot_orset<std::string, std::string>>(
+               writers));
+  }
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <chrono>
+#include <compare>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <flat_map.hpp>
+#include <version_vector.hpp>
+
+using namespace crdt;
+
+namespace {
+
+constexpr int actors = 1000;
+constexpr int rounds = 20000;
+
+// the three pass comparison version_vector used before the fused walk.
+template <typename V>
+auto legacy_compare(const V &left, const V &right) -> std::partial_ordering {
+  auto all_gt = [](const V &l, const V &r) {
+    return std::all_of(r.dots.begin(), r.dots.end(), [&l](const auto &d) {
+      return l.get(d.first) >= d.second;
+    });
+  };
+
+  if (left.dots.size() == right.dots.size() &&
+      std::equal(left.dots.begin(), left.dots.end(), right.dots.begin())) {
+    return std::partial_ordering::equivalent;
+  } else if (all_gt(left, right)) {
+    return std::partial_ordering::greater;
+  } else if (all_gt(right, left)) {
+    return std::partial_ordering::less;
+  }
+  return std::partial_ordering::unordered;
+}
+
+template <typename F> auto measure(F &&f) -> double {
+  volatile int sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; ++i)
+    sink = sink + (f() == std::partial_ordering::unordered);
+  std::chrono::duration<double, std::nano> spent =
+      std::chrono::steady_clock::now() - start;
+  return spent.count() / rounds;
+}
+
+void report(const std::string &name, double legacy, double fused) {
+  std::cout << std::left << std::setw(34) << name << std::right
+            << std::setw(12) << std::fixed << std::setprecision(1) << legacy
+            << std::setw(12) << fused << std::setw(10) << std::setprecision(2)
+            << legacy / fused << "x\n";
+}
+
+template <typename V> void run(const std::string &backend) {
+  V base, dominated, concurrent;
+  for (int actor = 0; actor < actors; ++actor) {
+    base.dots[actor] = 10;
+    dominated.dots[actor] = 9;
+    concurrent.dots[actor] = 10;
+  }
+  V equal, rehashed;
+  rehashed.dots.reserve(8 * actors);
+  for (int actor = actors - 1; actor >= 0; --actor) {
+    equal.dots[actor] = 10;
+    rehashed.dots[actor] = 10;
+  }
+  concurrent.dots[0] = 11;
+  concurrent.dots[1] = 9;
+
+  report(backend + " equal", measure([&] { return legacy_compare(base, equal); }),
+         measure([&] { return base <=> equal; }));
+  report(backend + " equal, other history",
+         measure([&] { return legacy_compare(base, rehashed); }),
+         measure([&] { return base <=> rehashed; }));
+  report(backend + " greater",
+         measure([&] { return legacy_compare(base, dominated); }),
+         measure([&] { return base <=> dominated; }));
+  report(backend + " concurrent",
+         measure([&] { return legacy_compare(base, concurrent); }),
+         measure([&] { return base <=> concurrent; }));
+}
+
+} // namespace
+
+auto main() -> int {
+  std::cout << actors << " actor clocks, ns per comparison\n"
+            << std::left << std::setw(34) << "case" << std::right
+            << std::setw(12) << "three-pass" << std::setw(12) << "fused"
+            << std::setw(11) << "speed-up\n";
+
+  run<version_vector<int>>("unordered_map");
+  run<version_vector<int, flat_map<int, std::uint64_t>>>("flat_map");
+}
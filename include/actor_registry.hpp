@@ -0,0 +1,127 @@
+#ifndef ACTOR_REGISTRY_H
+#define ACTOR_REGISTRY_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <context.hpp>
+#include <crdt_traits.hpp>
+#include <dot.hpp>
+#include <version_vector.hpp>
+
+namespace crdt {
+
+/// Dense replica-local handle of an interned actor.
+enum class actor_id : std::uint32_t {};
+
+constexpr auto index(actor_id id) noexcept -> std::uint32_t {
+  return static_cast<std::uint32_t>(id);
+}
+
+/// Replica-wide dictionary mapping external actors to dense actor_id's.
+/// Ids are handed out in registration order starting from zero and are never
+/// reused, so clocks, dots and contexts can be kept in id space and translated
+/// back only when they leave the replica.
+template <actor_type _Actor, typename _Hash = std::hash<_Actor>>
+class actor_registry {
+public:
+  actor_registry() = default;
+  actor_registry(const actor_registry &) = delete;
+  actor_registry &operator=(const actor_registry &) = delete;
+
+  auto intern(const _Actor &actor) -> actor_id {
+    {
+      std::shared_lock lock(mtx);
+      if (auto it = ids.find(actor); it != ids.end())
+        return it->second;
+    }
+
+    std::unique_lock lock(mtx);
+    auto [it, inserted] =
+        ids.emplace(actor, actor_id{static_cast<std::uint32_t>(actors.size())});
+    if (inserted)
+      actors.push_back(actor);
+    return it->second;
+  }
+
+  auto find(const _Actor &actor) const -> std::optional<actor_id> {
+    std::shared_lock lock(mtx);
+    if (auto it = ids.find(actor); it != ids.end())
+      return it->second;
+    return std::nullopt;
+  }
+
+  /// References stay valid for the registry lifetime, actors are never
+  /// dropped.
+  auto actor(actor_id id) const -> const _Actor & {
+    std::shared_lock lock(mtx);
+    return actors[index(id)];
+  }
+
+  auto size() const -> std::size_t {
+    std::shared_lock lock(mtx);
+    return actors.size();
+  }
+
+  auto intern(const dot<_Actor> &d) -> dot<actor_id> {
+    return dot<actor_id>(intern(d.actor), d.counter);
+  }
+
+  auto externalize(const dot<actor_id> &d) const -> dot<_Actor> {
+    return dot<_Actor>(actor(d.actor), d.counter);
+  }
+
+  template <iterable_assiative_type<actor_id, std::uint64_t> _Id_map =
+                default_dots_map<actor_id>,
+            iterable_assiative_type<_Actor, std::uint64_t> _Map>
+  auto intern(const version_vector<_Actor, _Map> &v)
+      -> version_vector<actor_id, _Id_map> {
+    version_vector<actor_id, _Id_map> res;
+    for (const auto &[actor, counter] : v.dots)
+      res.dots[intern(actor)] = counter;
+    return res;
+  }
+
+  template <iterable_assiative_type<_Actor, std::uint64_t> _Map =
+                default_dots_map<_Actor>,
+            iterable_assiative_type<actor_id, std::uint64_t> _Id_map>
+  auto externalize(const version_vector<actor_id, _Id_map> &v) const
+      -> version_vector<_Actor, _Map> {
+    version_vector<_Actor, _Map> res;
+    for (const auto &[id, counter] : v.dots)
+      res.dots[actor(id)] = counter;
+    return res;
+  }
+
+  auto intern(const add_context<_Actor> &ctx) -> add_context<actor_id> {
+    return add_context<actor_id>{intern(ctx.vector), intern(ctx.dot)};
+  }
+
+  auto externalize(const add_context<actor_id> &ctx) const
+      -> add_context<_Actor> {
+    return add_context<_Actor>{externalize(ctx.vector), externalize(ctx.dot)};
+  }
+
+  auto intern(const remove_context<_Actor> &ctx) -> remove_context<actor_id> {
+    return remove_context<actor_id>{intern(ctx.vector)};
+  }
+
+  auto externalize(const remove_context<actor_id> &ctx) const
+      -> remove_context<_Actor> {
+    return remove_context<_Actor>{externalize(ctx.vector)};
+  }
+
+private:
+  mutable std::shared_mutex mtx;
+  std::unordered_map<_Actor, actor_id, _Hash> ids;
+  std::deque<_Actor> actors;
+};
+
+} // namespace crdt.
+
+#endif // ACTOR_REGISTRY_H
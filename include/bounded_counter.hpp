@@ -0,0 +1,193 @@
+#ifndef BOUNDED_COUNTER_H
+#define BOUNDED_COUNTER_H
+
+#include <cstdint>
+#include <optional>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+
+#include <crdt_traits.hpp>
+#include <dot.hpp>
+#include <gcounter.hpp>
+#include <version_vector.hpp>
+
+namespace crdt {
+
+/// Counter that never drops below zero without coordinating decrements.
+/// Every actor holds rights: what it incremented plus what others
+/// transferred to it, minus what it decremented or transferred away. An
+/// actor only decrements within its own rights, so checking them is a
+/// local read, and actors running low ask others to transfer some of
+/// theirs.
+///
+/// Increments and decrements are gcounters, transfers one gcounter per
+/// sender whose entries are the amounts sent to each receiver, so every
+/// part merges by taking per-entry maxima as gcounter does.
+template <actor_type A> struct bounded_counter {
+  using actor_t = A;
+
+  gcounter<A> p, n;
+  std::unordered_map<A, gcounter<A>> transfers;
+
+  bounded_counter() = default;
+  bounded_counter(const bounded_counter<A> &) = default;
+  bounded_counter(bounded_counter<A> &&) = default;
+  bounded_counter<A> &operator=(const bounded_counter<A> &) = default;
+  bounded_counter<A> &operator=(bounded_counter<A> &&) = default;
+
+  auto operator==(const bounded_counter<A> &) const noexcept -> bool = default;
+
+  struct Inc {
+    dot<A> d;
+  };
+
+  struct Dec {
+    dot<A> d;
+  };
+
+  /// d.actor received d.counter in total from sender.
+  struct Transfer {
+    A sender;
+    dot<A> d;
+  };
+
+  using Op = std::variant<Inc, Dec, Transfer>;
+
+  /// Ops are validated where they are made: a replica that has not seen
+  /// the transfers behind a remote op may find the sender short of rights.
+  auto validate_op(const Op &op) const noexcept
+      -> std::optional<std::error_condition> {
+    return std::visit(
+        overloaded{
+            [](const Inc &) -> std::optional<std::error_condition> {
+              return std::nullopt;
+            },
+            [this](const Dec &dec) {
+              return validate_spend(dec.d.actor, dec.d.counter,
+                                    n.get(dec.d.actor));
+            },
+            [this](const Transfer &t) -> std::optional<std::error_condition> {
+              if (t.sender == t.d.actor)
+                return std::make_error_condition(std::errc::invalid_argument);
+              return validate_spend(t.sender, t.d.counter,
+                                    sent(t.sender, t.d.actor));
+            },
+        },
+        op);
+  }
+
+  void apply(const Op &op) noexcept {
+    std::visit(overloaded{
+                   [this](const Inc &inc) { p.apply(inc.d); },
+                   [this](const Dec &dec) { n.apply(dec.d); },
+                   [this](const Transfer &t) {
+                     transfers[t.sender].apply(t.d);
+                   },
+               },
+               op);
+  }
+
+  auto validate_merge(const bounded_counter<A> &) const noexcept
+      -> std::optional<std::error_condition> {
+    return std::nullopt;
+  }
+
+  void merge(const bounded_counter<A> &other) noexcept {
+    p.merge(other.p);
+    n.merge(other.n);
+    for (const auto &[sender, sent] : other.transfers)
+      transfers[sender].merge(sent);
+  }
+
+  void reset_remove(const version_vector<A> &v) noexcept {
+    p.reset_remove(v);
+    n.reset_remove(v);
+    for (auto &[sender, sent] : transfers)
+      sent.reset_remove(v);
+  }
+
+  /// What a may still decrement or transfer. Exact for the local actor;
+  /// for others it reflects only what this replica has seen.
+  auto rights(const A &a) const noexcept -> std::uint64_t {
+    auto received = p.get(a);
+    for (const auto &[sender, sent] : transfers)
+      received += sent.get(a);
+    std::uint64_t spent = n.get(a);
+    if (auto it = transfers.find(a); it != transfers.end())
+      spent += it->second.read();
+    return received > spent ? received - spent : 0;
+  }
+
+  auto validate_dec(const A &a, std::uint64_t steps = 1) const noexcept
+      -> std::optional<std::error_condition> {
+    if (rights(a) < steps)
+      return std::make_error_condition(
+          std::errc::resource_unavailable_try_again);
+    return std::nullopt;
+  }
+
+  auto validate_transfer(const A &from, const A &to,
+                         std::uint64_t steps) const noexcept
+      -> std::optional<std::error_condition> {
+    if (from == to)
+      return std::make_error_condition(std::errc::invalid_argument);
+    return validate_dec(from, steps);
+  }
+
+  /// Adds steps to the counter and to a's rights, returns the delta.
+  auto inc(const A &a, std::uint64_t steps = 1) noexcept
+      -> bounded_counter<A> {
+    bounded_counter<A> delta;
+    delta.p = p.inc(a, steps);
+    return delta;
+  }
+
+  /// Takes steps off the counter out of a's rights and returns the delta.
+  /// Nothing changes and the delta is empty when validate_dec(a, steps)
+  /// fails.
+  auto dec(const A &a, std::uint64_t steps = 1) noexcept
+      -> bounded_counter<A> {
+    bounded_counter<A> delta;
+    if (validate_dec(a, steps) == std::nullopt)
+      delta.n = n.inc(a, steps);
+    return delta;
+  }
+
+  /// Moves steps of from's rights to to and returns the delta. Nothing
+  /// changes and the delta is empty when validate_transfer fails.
+  auto transfer(const A &from, const A &to, std::uint64_t steps) noexcept
+      -> bounded_counter<A> {
+    bounded_counter<A> delta;
+    if (validate_transfer(from, to, steps) == std::nullopt)
+      delta.transfers[from] = transfers[from].inc(to, steps);
+    return delta;
+  }
+
+  /// Zero while a replica has seen decrements but not yet the increments
+  /// that granted the rights for them.
+  auto read() const noexcept -> std::uint64_t {
+    auto added = p.read(), taken = n.read();
+    return added > taken ? added - taken : 0;
+  }
+
+private:
+  auto sent(const A &from, const A &to) const noexcept -> std::uint64_t {
+    auto it = transfers.find(from);
+    return it == transfers.end() ? 0 : it->second.get(to);
+  }
+
+  /// An op raising a's counter from current to total spends the difference.
+  auto validate_spend(const A &a, std::uint64_t total,
+                      std::uint64_t current) const noexcept
+      -> std::optional<std::error_condition> {
+    if (total <= current)
+      return std::nullopt;
+    return validate_dec(a, total - current);
+  }
+};
+
+} // namespace crdt.
+
+#endif // BOUNDED_COUNTER_H
@@ -0,0 +1,475 @@
+#ifndef BTREE_MAP_H
+#define BTREE_MAP_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace crdt {
+
+/// Ordered map kept in a B+tree: entries live in sorted arrays in the leaves,
+/// which are linked for iteration, and inner nodes hold only separator keys.
+/// A lookup binary searches a few arrays of about 512 bytes each and a scan
+/// walks leaves sequentially, so iterating entries or a key range stays
+/// cache friendly. Used as the entries map of ormwot, it gives ordered range
+/// and prefix queries and lets merges walk both maps in key order.
+///
+/// Erasing never moves entries of other leaves: erase(it) returns the next
+/// entry and keeps iterators into other leaves valid. A leaf is freed once
+/// it runs empty rather than merged with its siblings. Inserting may split
+/// nodes and invalidates every iterator.
+template <std::default_initializable _Key, std::default_initializable _Tp,
+          typename _Compare = std::less<_Key>>
+class btree_map {
+public:
+  using key_type = _Key;
+  using mapped_type = _Tp;
+  using value_type = std::pair<_Key, _Tp>;
+  using key_compare = _Compare;
+  using size_type = std::size_t;
+
+private:
+  static constexpr size_type node_bytes = 512;
+  static constexpr size_type leaf_slots =
+      std::clamp<size_type>(node_bytes / sizeof(value_type), 4, 64);
+  static constexpr size_type inner_slots =
+      std::clamp<size_type>(node_bytes / sizeof(_Key), 4, 64);
+
+  struct node {};
+
+  struct leaf : node {
+    size_type count = 0;
+    leaf *prev = nullptr;
+    leaf *next = nullptr;
+    std::array<value_type, leaf_slots> entries;
+  };
+
+  /// children[i] holds the keys k with keys[i - 1] <= k < keys[i].
+  struct inner : node {
+    size_type count = 0;
+    std::array<_Key, inner_slots - 1> keys;
+    std::array<node *, inner_slots> children;
+  };
+
+public:
+  template <bool Const> class basic_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = btree_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<Const, const value_type &, value_type &>;
+    using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+
+    basic_iterator() = default;
+    basic_iterator(leaf *at, size_type slot) : at(at), slot(slot) {}
+    template <bool Other>
+      requires(Const && !Other)
+    basic_iterator(const basic_iterator<Other> &other)
+        : at(other.at), slot(other.slot) {}
+
+    auto operator*() const -> reference { return at->entries[slot]; }
+    auto operator->() const -> pointer { return &at->entries[slot]; }
+
+    auto operator++() -> basic_iterator & {
+      if (++slot == at->count) {
+        at = at->next;
+        slot = 0;
+      }
+      return *this;
+    }
+    auto operator++(int) -> basic_iterator {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    friend auto operator==(const basic_iterator &l,
+                           const basic_iterator &r) noexcept -> bool {
+      return l.at == r.at && l.slot == r.slot;
+    }
+
+  private:
+    friend class btree_map;
+    template <bool> friend class basic_iterator;
+
+    leaf *at = nullptr;
+    size_type slot = 0;
+  };
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  btree_map() = default;
+
+  btree_map(const btree_map &other) : btree_map() {
+    if (other.root == nullptr)
+      return;
+    leaf *last = nullptr;
+    root = copy(other.root, other.height, last);
+    height = other.height;
+    count = other.count;
+  }
+
+  btree_map(btree_map &&other) noexcept { swap(other); }
+
+  btree_map &operator=(btree_map other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~btree_map() { clear(); }
+
+  void swap(btree_map &other) noexcept {
+    std::swap(root, other.root);
+    std::swap(height, other.height);
+    std::swap(count, other.count);
+  }
+
+  auto operator==(const btree_map &other) const -> bool
+    requires std::equality_comparable<_Key> && std::equality_comparable<_Tp>
+  {
+    return size() == other.size() &&
+           std::equal(begin(), end(), other.begin(), other.end());
+  }
+
+  auto begin() noexcept -> iterator { return iterator(first_leaf(), 0); }
+  auto end() noexcept -> iterator { return iterator(); }
+  auto begin() const noexcept -> const_iterator {
+    return const_iterator(first_leaf(), 0);
+  }
+  auto end() const noexcept -> const_iterator { return const_iterator(); }
+  auto cbegin() const noexcept -> const_iterator { return begin(); }
+  auto cend() const noexcept -> const_iterator { return end(); }
+
+  auto size() const noexcept -> size_type { return count; }
+  auto empty() const noexcept -> bool { return count == 0; }
+
+  void clear() noexcept {
+    if (root != nullptr)
+      destroy(root, height);
+    root = nullptr;
+    height = 0;
+    count = 0;
+  }
+
+  auto key_comp() const noexcept -> key_compare { return key_compare{}; }
+
+  /// First entry whose key is not less than key.
+  auto lower_bound(const _Key &key) noexcept -> iterator {
+    return bound(key, [](const value_type &entry, const _Key &key) {
+      return key_compare{}(entry.first, key);
+    });
+  }
+  auto lower_bound(const _Key &key) const noexcept -> const_iterator {
+    return const_cast<btree_map *>(this)->lower_bound(key);
+  }
+
+  /// First entry whose key is greater than key.
+  auto upper_bound(const _Key &key) noexcept -> iterator {
+    return bound(key, [](const value_type &entry, const _Key &key) {
+      return !key_compare{}(key, entry.first);
+    });
+  }
+  auto upper_bound(const _Key &key) const noexcept -> const_iterator {
+    return const_cast<btree_map *>(this)->upper_bound(key);
+  }
+
+  auto find(const _Key &key) noexcept -> iterator {
+    auto it = lower_bound(key);
+    return it != end() && !key_compare{}(key, it->first) ? it : end();
+  }
+  auto find(const _Key &key) const noexcept -> const_iterator {
+    return const_cast<btree_map *>(this)->find(key);
+  }
+
+  auto contains(const _Key &key) const noexcept -> bool {
+    return find(key) != end();
+  }
+
+  auto operator[](const _Key &key) -> _Tp & {
+    return emplace(key).first->second;
+  }
+
+  template <typename... Args>
+  auto emplace(const _Key &key, Args &&...args) -> std::pair<iterator, bool> {
+    if (root == nullptr) {
+      root = new leaf;
+      height = 0;
+    }
+
+    std::vector<std::pair<inner *, size_type>> path;
+    auto *at = descend(key, path);
+    auto slot = leaf_position(at, key);
+    if (slot != at->count && !key_compare{}(key, at->entries[slot].first))
+      return {iterator(at, slot), false};
+
+    if (at->count == leaf_slots) {
+      auto *right = split(at, path);
+      if (slot > at->count) {
+        slot -= at->count;
+        at = right;
+      }
+    }
+    std::move_backward(at->entries.begin() + slot,
+                       at->entries.begin() + at->count,
+                       at->entries.begin() + at->count + 1);
+    at->entries[slot] = value_type(key, _Tp(std::forward<Args>(args)...));
+    ++at->count;
+    ++count;
+    return {iterator(at, slot), true};
+  }
+
+  auto insert(const value_type &value) -> std::pair<iterator, bool> {
+    return emplace(value.first, value.second);
+  }
+
+  auto erase(const_iterator pos) -> iterator {
+    auto *at = pos.at;
+    auto slot = pos.slot;
+    --count;
+    if (at->count > 1) {
+      std::move(at->entries.begin() + slot + 1,
+                at->entries.begin() + at->count, at->entries.begin() + slot);
+      at->entries[--at->count] = value_type{};
+      return slot == at->count ? iterator(at->next, 0) : iterator(at, slot);
+    }
+
+    auto *next = at->next;
+    unlink(at);
+    return iterator(next, 0);
+  }
+
+  auto erase(iterator pos) -> iterator { return erase(const_iterator(pos)); }
+
+  auto erase(const _Key &key) -> size_type {
+    if (auto it = find(key); it != end()) {
+      erase(it);
+      return 1;
+    }
+    return 0;
+  }
+
+private:
+  auto first_leaf() const noexcept -> leaf * {
+    if (root == nullptr || count == 0)
+      return nullptr;
+    auto *at = root;
+    for (auto level = height; level > 0; --level)
+      at = static_cast<inner *>(at)->children[0];
+    return static_cast<leaf *>(at);
+  }
+
+  /// Index of the child of n whose range holds key.
+  static auto child_position(const inner *n, const _Key &key) noexcept
+      -> size_type {
+    return std::upper_bound(n->keys.begin(), n->keys.begin() + n->count - 1,
+                            key, key_compare{}) -
+           n->keys.begin();
+  }
+
+  static auto leaf_position(const leaf *n, const _Key &key) noexcept
+      -> size_type {
+    return std::lower_bound(n->entries.begin(), n->entries.begin() + n->count,
+                            key,
+                            [](const value_type &entry, const _Key &key) {
+                              return key_compare{}(entry.first, key);
+                            }) -
+           n->entries.begin();
+  }
+
+  /// Leaf whose range holds key, recording the inner nodes passed and the
+  /// child taken in each.
+  auto descend(const _Key &key, std::vector<std::pair<inner *, size_type>> &path)
+      const -> leaf * {
+    path.reserve(height);
+    auto *at = root;
+    for (auto level = height; level > 0; --level) {
+      auto *n = static_cast<inner *>(at);
+      auto child = child_position(n, key);
+      path.emplace_back(n, child);
+      at = n->children[child];
+    }
+    return static_cast<leaf *>(at);
+  }
+
+  template <typename _Before>
+  auto bound(const _Key &key, _Before before) noexcept -> iterator {
+    if (root == nullptr || count == 0)
+      return end();
+    auto *at = root;
+    for (auto level = height; level > 0; --level)
+      at = static_cast<inner *>(at)->children[child_position(
+          static_cast<inner *>(at), key)];
+    auto *l = static_cast<leaf *>(at);
+    auto slot = std::partition_point(l->entries.begin(),
+                                     l->entries.begin() + l->count,
+                                     [&](const value_type &entry) {
+                                       return before(entry, key);
+                                     }) -
+                l->entries.begin();
+    if (static_cast<size_type>(slot) == l->count)
+      return iterator(l->next, 0);
+    return iterator(l, slot);
+  }
+
+  /// Moves the upper half of a full leaf into a new right sibling and
+  /// registers it with the parent, splitting inner nodes up the path as
+  /// they fill.
+  auto split(leaf *l, std::vector<std::pair<inner *, size_type>> &path)
+      -> leaf * {
+    auto *right = new leaf;
+    auto half = l->count / 2;
+    std::move(l->entries.begin() + half, l->entries.begin() + l->count,
+              right->entries.begin());
+    std::fill(l->entries.begin() + half, l->entries.begin() + l->count,
+              value_type{});
+    right->count = l->count - half;
+    l->count = half;
+
+    right->next = l->next;
+    right->prev = l;
+    if (l->next != nullptr)
+      l->next->prev = right;
+    l->next = right;
+
+    _Key separator = right->entries[0].first;
+    node *added = right;
+    while (!path.empty()) {
+      auto [parent, child] = path.back();
+      path.pop_back();
+      if (parent->count < inner_slots) {
+        insert_child(parent, child, std::move(separator), added);
+        return right;
+      }
+
+      // split the parent: the upper half moves to a new sibling and the
+      // key between both halves goes one level up.
+      auto *sibling = new inner;
+      auto keep = parent->count / 2;
+      auto moved = parent->count - keep;
+      std::move(parent->keys.begin() + keep,
+                parent->keys.begin() + parent->count - 1,
+                sibling->keys.begin());
+      std::copy(parent->children.begin() + keep,
+                parent->children.begin() + parent->count,
+                sibling->children.begin());
+      sibling->count = moved;
+      _Key promoted = std::move(parent->keys[keep - 1]);
+      parent->count = keep;
+
+      if (child < keep)
+        insert_child(parent, child, std::move(separator), added);
+      else
+        insert_child(sibling, child - keep, std::move(separator), added);
+      separator = std::move(promoted);
+      added = sibling;
+    }
+
+    auto *grown = new inner;
+    grown->count = 2;
+    grown->keys[0] = std::move(separator);
+    grown->children[0] = root;
+    grown->children[1] = added;
+    root = grown;
+    ++height;
+    return right;
+  }
+
+  /// Inserts child after position at of n, separated from it by key.
+  static void insert_child(inner *n, size_type at, _Key key,
+                           node *child) noexcept {
+    std::move_backward(n->keys.begin() + at, n->keys.begin() + n->count - 1,
+                       n->keys.begin() + n->count);
+    std::copy_backward(n->children.begin() + at + 1,
+                       n->children.begin() + n->count,
+                       n->children.begin() + n->count + 1);
+    n->keys[at] = std::move(key);
+    n->children[at + 1] = child;
+    ++n->count;
+  }
+
+  /// Frees a leaf whose last entry is being erased, along with every inner
+  /// node left without children.
+  void unlink(leaf *l) noexcept {
+    std::vector<std::pair<inner *, size_type>> path;
+    descend(l->entries[0].first, path);
+
+    if (l->prev != nullptr)
+      l->prev->next = l->next;
+    if (l->next != nullptr)
+      l->next->prev = l->prev;
+    delete l;
+
+    while (!path.empty()) {
+      auto [parent, child] = path.back();
+      path.pop_back();
+      if (parent->count > 1) {
+        remove_child(parent, child);
+        while (height > 0 && static_cast<inner *>(root)->count == 1) {
+          auto *collapsed = static_cast<inner *>(root);
+          root = collapsed->children[0];
+          --height;
+          delete collapsed;
+        }
+        return;
+      }
+      delete parent;
+    }
+    root = nullptr;
+    height = 0;
+  }
+
+  static void remove_child(inner *n, size_type at) noexcept {
+    auto key = at == 0 ? 0 : at - 1;
+    std::move(n->keys.begin() + key + 1, n->keys.begin() + n->count - 1,
+              n->keys.begin() + key);
+    std::copy(n->children.begin() + at + 1, n->children.begin() + n->count,
+              n->children.begin() + at);
+    --n->count;
+    n->keys[n->count - 1] = _Key{};
+  }
+
+  static auto copy(const node *from, size_type level, leaf *&last) -> node * {
+    if (level == 0) {
+      auto *l = new leaf(*static_cast<const leaf *>(from));
+      l->prev = last;
+      l->next = nullptr;
+      if (last != nullptr)
+        last->next = l;
+      last = l;
+      return l;
+    }
+    const auto *n = static_cast<const inner *>(from);
+    auto *copied = new inner;
+    copied->count = n->count;
+    copied->keys = n->keys;
+    for (size_type i = 0; i < n->count; ++i)
+      copied->children[i] = copy(n->children[i], level - 1, last);
+    return copied;
+  }
+
+  static void destroy(node *n, size_type level) noexcept {
+    if (level == 0) {
+      delete static_cast<leaf *>(n);
+      return;
+    }
+    auto *i = static_cast<inner *>(n);
+    for (size_type c = 0; c < i->count; ++c)
+      destroy(i->children[c], level - 1);
+    delete i;
+  }
+
+  node *root = nullptr;
+  /// Inner levels above the leaves.
+  size_type height = 0;
+  size_type count = 0;
+};
+
+} // namespace crdt.
+
+#endif // BTREE_MAP_H
@@ -0,0 +1,161 @@
+#ifndef CONCURRENT_ORSWOT_H
+#define CONCURRENT_ORSWOT_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <crdt_traits.hpp>
+#include <dot.hpp>
+#include <dot_cloud.hpp>
+#include <orswot.hpp>
+#include <version_vector.hpp>
+
+namespace crdt {
+
+/// orswot shared by the threads of one replica. Members are spread over
+/// _Shards independently locked orswots and the dots of the local actor come
+/// from one atomic counter, so writers on different shards never wait for
+/// each other. The causal context (clock and dot cloud) is kept once for
+/// all shards and only changes under every shard lock, that is in merge.
+template <actor_type _Key, actor_type _Actor, std::size_t _Shards = 32>
+class concurrent_orswot {
+public:
+  using orswot_type = orswot<_Key, _Actor>;
+  using vector_clock = typename orswot_type::vector_clock;
+  using cloud_type = typename orswot_type::cloud_type;
+  using Op = typename orswot_type::Op;
+  using Add = typename orswot_type::Add;
+  using Rm = typename orswot_type::Rm;
+
+  explicit concurrent_orswot(_Actor actor) : actor(std::move(actor)) {}
+
+  /// Adds member under a fresh dot of the local actor, the returned op
+  /// replicates it.
+  auto add(const _Key &member) -> Op {
+    auto &s = shard_of(member);
+    std::lock_guard guard(s.lock);
+    // the dot is drawn under the shard lock, so once every shard is locked
+    // the counter never names a dot missing from the entries.
+    dot<_Actor> d(actor, counter.fetch_add(1, std::memory_order_relaxed) + 1);
+    s.set.entries[member].apply(d);
+    return Add{std::move(d), {member}};
+  }
+
+  /// Removes member as observed locally, the returned op replicates it.
+  auto rm(const _Key &member) -> Op {
+    auto &s = shard_of(member);
+    std::lock_guard guard(s.lock);
+    vector_clock observed;
+    if (auto it = s.set.entries.find(member); it != s.set.entries.end()) {
+      observed = std::move(it->second);
+      s.set.entries.erase(it);
+    }
+    return Rm{std::move(observed), {member}};
+  }
+
+  auto contains(const _Key &member) const -> bool {
+    const auto &s = shard_of(member);
+    std::lock_guard guard(s.lock);
+    return s.set.entries.contains(member);
+  }
+
+  /// Consistent copy of the whole set as a plain orswot, ready to be
+  /// shipped or merged elsewhere.
+  auto snapshot() const -> orswot_type {
+    auto guards = lock_all();
+    orswot_type result;
+    result.clock = local_clock();
+    result.cloud = cloud;
+    for (const auto &s : shards) {
+      result.entries.insert(s.set.entries.begin(), s.set.entries.end());
+      s.set.deferred.for_each([&](const auto &rm_clock, const auto &members) {
+        result.deferred.defer(result.clock, rm_clock, members);
+      });
+    }
+    return result;
+  }
+
+  /// Merges a remote state shard by shard under every shard lock.
+  void merge(const orswot_type &other) {
+    auto guards = lock_all();
+    auto local = local_clock();
+
+    std::array<orswot_type, _Shards> parts;
+    for (auto &part : parts) {
+      part.clock = other.clock;
+      part.cloud = other.cloud;
+    }
+    for (const auto &[member, vclock] : other.entries)
+      parts[index_of(member)].entries.emplace(member, vclock);
+    other.deferred.for_each([&](const auto &rm_clock, const auto &members) {
+      for (const auto &member : members)
+        parts[index_of(member)].deferred.defer(vector_clock(), rm_clock,
+                                               std::array{member});
+    });
+
+    for (std::size_t i = 0; i < _Shards; ++i) {
+      auto &set = shards[i].set;
+      set.clock = local;
+      set.cloud = cloud;
+      set.merge(std::move(parts[i]));
+    }
+
+    clock = shards.front().set.clock;
+    cloud = shards.front().set.cloud;
+    counter.store(std::max(counter.load(std::memory_order_relaxed),
+                           clock.get(actor)),
+                  std::memory_order_relaxed);
+  }
+
+private:
+  struct alignas(64) shard {
+    mutable std::mutex lock;
+    orswot_type set;
+  };
+
+  static auto index_of(const _Key &member) -> std::size_t {
+    return std::hash<_Key>{}(member) % _Shards;
+  }
+
+  auto shard_of(const _Key &member) -> shard & {
+    return shards[index_of(member)];
+  }
+  auto shard_of(const _Key &member) const -> const shard & {
+    return shards[index_of(member)];
+  }
+
+  /// Locks every shard, always in the same order.
+  auto lock_all() const -> std::vector<std::unique_lock<std::mutex>> {
+    std::vector<std::unique_lock<std::mutex>> guards;
+    guards.reserve(_Shards);
+    for (const auto &s : shards)
+      guards.emplace_back(s.lock);
+    return guards;
+  }
+
+  /// Shared clock including the local actor's dots, every shard must be
+  /// locked.
+  auto local_clock() const -> vector_clock {
+    auto local(clock);
+    if (auto c = counter.load(std::memory_order_relaxed); c > 0)
+      local.apply(dot(actor, c));
+    return local;
+  }
+
+  _Actor actor;
+  alignas(64) std::atomic<std::uint64_t> counter{0};
+  vector_clock clock;
+  cloud_type cloud;
+  std::array<shard, _Shards> shards;
+};
+
+} // namespace crdt.
+
+#endif // CONCURRENT_ORSWOT_H
@@ -1,6 +1,8 @@
 #ifndef CONTEXT_H
 #define CONTEXT_H
 
+#include <iterator>
+#include <ranges>
 #include <unordered_map>
 #include <utility>
 
@@ -47,6 +49,63 @@ struct read_context {
   }
 };
 
+/// Outcome of a membership lookup: present when member_clock is set. Both
+/// clocks are referenced from the replica rather than copied, so the
+/// handle is only valid until the replica is modified. The member clock may
+/// use another dots backend than the replica's.
+template <actor_type A, typename _Member_clock = version_vector<A>>
+struct lookup_context {
+  const version_vector<A> *clock = nullptr;
+  const _Member_clock *member_clock = nullptr;
+
+  explicit operator bool() const noexcept { return member_clock != nullptr; }
+
+  auto derive_add_context(A a) const noexcept -> add_context<A> {
+    auto ret = *clock;
+    auto d = ret.inc(a);
+    ret.apply(d);
+    return add_context<A>{std::move(ret), std::move(d)};
+  }
+
+  /// Context removing exactly the dots observed for the member, empty when
+  /// it is absent.
+  auto derive_remove_context() const noexcept -> remove_context<A> {
+    if (member_clock == nullptr)
+      return remove_context<A>{};
+    return remove_context<A>{clock_cast<version_vector<A>>(*member_clock)};
+  }
+};
+
+/// Read context shared by every element of a range read straight from a
+/// replica's entries. Neither the elements nor the clock are copied, so a
+/// read_view is only valid until the replica is modified.
+template <std::ranges::view V, actor_type A>
+struct read_view : std::ranges::view_interface<read_view<V, A>> {
+  const version_vector<A> *clock = nullptr;
+  V value;
+
+  read_view() = default;
+  read_view(const version_vector<A> &clock, V value)
+      : clock(&clock), value(std::move(value)) {}
+
+  auto begin() const { return std::ranges::begin(value); }
+  auto end() const { return std::ranges::end(value); }
+  auto size() const requires std::ranges::sized_range<const V> {
+    return std::ranges::size(value);
+  }
+
+  auto derive_add_context(A a) const noexcept -> add_context<A> {
+    auto ret = *clock;
+    auto d = ret.inc(a);
+    ret.apply(d);
+    return add_context<A>{std::move(ret), std::move(d)};
+  }
+
+  auto derive_remove_context() const noexcept -> remove_context<A> {
+    return remove_context<A>{*clock};
+  }
+};
+
 } // namespace crdt.
 
 #endif // CONTEXT_H
@@ -2,6 +2,8 @@
 #define CRDT_TRAITS_H
 
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <type_traits>
 #include <optional>
@@ -75,7 +77,49 @@ concept cmrdt = requires(T a, typename T::Op op) {
     { a.apply(op) };
 };
 
-template<actor_type A, iterable_assiative_type<A, std::uint64_t> T = std::unordered_map<A, std::uint64_t>> struct version_vector;
+template <typename T>
+concept ordered_type = requires(const T t) {
+	typename T::key_compare;
+	{ t.key_comp() } -> std::convertible_to<typename T::key_compare>;
+};
+
+template <typename T>
+concept dense_type = requires(T t, const T ct, std::size_t n) {
+	{ ct.data() } -> std::same_as<const std::uint64_t *>;
+	{ ct.extent() } -> std::convertible_to<std::size_t>;
+	{ t.grow(n) };
+};
+
+template <typename T>
+concept fixed_type = dense_type<T> && requires {
+	{ std::integral_constant<std::size_t, T::static_extent>::value };
+};
+
+/// Containers sharing structure between copies: snapshot() is a cheap copy
+/// and writes only copy the part of the structure they touch.
+template <typename T>
+concept persistent_type = requires(const T t) {
+	{ t.snapshot() } -> std::same_as<T>;
+};
+
+/// Selects the container backing version_vector<A> when none is given
+/// explicitly. Specialize it for an actor type to switch every clock of
+/// that actor (including the ones inside orswot, ormwot and mvreg) to
+/// another backend, e.g. flat_map<A, std::uint64_t>.
+template <actor_type A> struct dots_map_traits {
+	using type = std::unordered_map<A, std::uint64_t>;
+};
+
+template <actor_type A> using default_dots_map = typename dots_map_traits<A>::type;
+
+template<actor_type A, iterable_assiative_type<A, std::uint64_t> T = default_dots_map<A>> struct version_vector;
+
+/// Maps keys K to version vectors of actor A held in any dots backend, e.g.
+/// the entries of an orswot.
+template <typename T, typename K, typename A>
+concept clock_map_type = iterable_assiative_type<T, K, typename T::mapped_type>
+	&& std::is_same_v<typename T::mapped_type,
+	                  version_vector<A, typename T::mapped_type::dots_map>>;
 
 template <typename T>
 concept crdt = cvrdt<T> && cmrdt<T> && requires(T t, version_vector<typename T::actor_t> v) {
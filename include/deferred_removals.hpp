@@ -0,0 +1,164 @@
+#ifndef DEFERRED_REMOVALS_H
+#define DEFERRED_REMOVALS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include <crdt_traits.hpp>
+#include <version_vector.hpp>
+
+namespace crdt {
+
+/// Removals whose context is ahead of the local clock, shared by orswot and
+/// ormwot. A pending removal is indexed under every actor the local clock is
+/// still behind on by the counter it waits for, so advancing the clock only
+/// visits the removals it releases, and it is indexed by member, so an add
+/// only revisits the removals naming the members it touches. A removal is
+/// dropped as soon as the local clock covers it: from then on every dot it
+/// can remove has already been seen and removed.
+///
+/// _Map must keep references to its elements stable, as the node based
+/// standard containers do.
+template <actor_type _Actor, actor_type _Key, set_type<_Key> _Key_set,
+          iterable_assiative_type<version_vector<_Actor>, _Key_set> _Map =
+              std::unordered_map<version_vector<_Actor>, _Key_set>>
+class deferred_removals {
+public:
+  using vector_clock = version_vector<_Actor>;
+  using key_type = vector_clock;
+  using mapped_type = _Key_set;
+  using size_type = std::size_t;
+  using const_iterator = typename _Map::const_iterator;
+
+  deferred_removals() = default;
+  deferred_removals(deferred_removals &&) = default;
+  deferred_removals &operator=(deferred_removals &&) = default;
+
+  deferred_removals(const deferred_removals &other)
+      : removals(other.removals) {
+    for (const auto &[actor, thresholds] : other.waiting) {
+      auto &ours = waiting[actor];
+      for (const auto &[counter, key] : thresholds)
+        ours.emplace_hint(ours.end(), counter, rebind(key));
+    }
+    for (const auto &[key, count] : other.behind)
+      behind.emplace(rebind(key), count);
+    for (const auto &[member, key] : other.by_member)
+      by_member.emplace(member, rebind(key));
+  }
+
+  deferred_removals &operator=(const deferred_removals &other) {
+    if (this != &other)
+      *this = deferred_removals(other);
+    return *this;
+  }
+
+  auto begin() const noexcept -> const_iterator { return removals.begin(); }
+  auto end() const noexcept -> const_iterator { return removals.end(); }
+
+  auto size() const noexcept -> size_type { return removals.size(); }
+  auto empty() const noexcept -> bool { return removals.empty(); }
+
+  /// Keeps the removal of members under rm unless local already covers it.
+  template <typename _Members>
+  void defer(const vector_clock &local, const vector_clock &rm,
+             const _Members &members) {
+    if (local.dominates(rm))
+      return;
+
+    auto [it, inserted] = removals.emplace(rm, _Key_set());
+    const auto *key = &it->first;
+    if (inserted) {
+      for (const auto &[actor, counter] : rm.dots) {
+        if (local.get(actor) < counter) {
+          waiting[actor].emplace(counter, key);
+          ++behind[key];
+        }
+      }
+    }
+
+    for (const auto &member : members)
+      if (it->second.insert(member).second)
+        by_member.emplace(member, key);
+  }
+
+  /// Calls f(rm) for every pending removal naming member.
+  template <typename F> void for_each(const _Key &member, F &&f) const {
+    auto [first, last] = by_member.equal_range(member);
+    for (; first != last; ++first)
+      f(*first->second);
+  }
+
+  /// Calls f(rm, members) for every pending removal.
+  template <typename F> void for_each(F &&f) const {
+    for (const auto &[rm, members] : removals)
+      f(rm, members);
+  }
+
+  /// Drops the removals local has caught up with.
+  void release(const vector_clock &local) {
+    for (auto it = waiting.begin(); it != waiting.end();) {
+      auto &thresholds = it->second;
+      auto last = thresholds.upper_bound(local.get(it->first));
+      for (auto t = thresholds.begin(); t != last; ++t)
+        if (auto count = behind.find(t->second); --count->second == 0)
+          drop(count);
+      thresholds.erase(thresholds.begin(), last);
+      it = thresholds.empty() ? waiting.erase(it) : std::next(it);
+    }
+  }
+
+  /// Mirrors version_vector::reset_remove on every pending removal, local is
+  /// the clock after its own reset.
+  void reset_remove(const vector_clock &vclock, const vector_clock &local) {
+    deferred_removals reset;
+    for (const auto &[rm, members] : removals) {
+      auto rest(rm);
+      rest.reset_remove(vclock);
+      if (!rest.empty())
+        reset.defer(local, rest, members);
+    }
+    *this = std::move(reset);
+  }
+
+private:
+  using behind_map = std::unordered_map<const vector_clock *, std::size_t>;
+
+  auto rebind(const vector_clock *key) const -> const vector_clock * {
+    return &removals.find(*key)->first;
+  }
+
+  void drop(typename behind_map::iterator count) {
+    const auto *key = count->first;
+    behind.erase(count);
+
+    auto it = removals.find(*key);
+    for (const auto &member : it->second) {
+      auto [first, last] = by_member.equal_range(member);
+      for (; first != last; ++first) {
+        if (first->second == key) {
+          by_member.erase(first);
+          break;
+        }
+      }
+    }
+    removals.erase(it);
+  }
+
+  _Map removals;
+  /// Pending removals by the actor the local clock lags on and the counter
+  /// it has to reach.
+  std::unordered_map<_Actor, std::multimap<std::uint64_t, const vector_clock *>>
+      waiting;
+  /// Number of actors every pending removal still waits on.
+  behind_map behind;
+  std::unordered_multimap<_Key, const vector_clock *> by_member;
+};
+
+} // namespace crdt.
+
+#endif // DEFERRED_REMOVALS_H
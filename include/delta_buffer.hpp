@@ -0,0 +1,85 @@
+#ifndef DELTA_BUFFER_H
+#define DELTA_BUFFER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#include <crdt_traits.hpp>
+
+namespace crdt {
+
+/// Deltas produced by the local replica, numbered in the order they were
+/// produced. A peer acknowledging sequence number n has received every delta
+/// below n, interval(n) joins whatever it is still missing into one delta,
+/// and deltas every known peer has acknowledged are dropped.
+template <cvrdt _Delta, actor_type _Peer> class delta_buffer {
+public:
+  using delta_type = _Delta;
+  using seq_type = std::uint64_t;
+
+  /// Sequence number the next pushed delta gets.
+  auto seq() const noexcept -> seq_type { return base + deltas.size(); }
+
+  /// Oldest sequence number still buffered.
+  auto first_seq() const noexcept -> seq_type { return base; }
+
+  auto size() const noexcept -> std::size_t { return deltas.size(); }
+  auto empty() const noexcept -> bool { return deltas.empty(); }
+
+  auto push(_Delta delta) -> seq_type {
+    deltas.push_back(std::move(delta));
+    return seq() - 1;
+  }
+
+  /// Join of the deltas numbered since and later, or nullopt when some of
+  /// them were already dropped and the peer has to fall back to full state.
+  auto interval(seq_type since) const -> std::optional<_Delta> {
+    if (since < base)
+      return std::nullopt;
+
+    std::optional<_Delta> joined(std::in_place);
+    for (auto it = deltas.begin() + std::min(since - base, seq() - base);
+         it != deltas.end(); ++it)
+      joined->merge(*it);
+    return joined;
+  }
+
+  /// Records that peer has received every delta below seq.
+  void ack(const _Peer &peer, seq_type seq) {
+    auto &acked = peers[peer];
+    acked = std::max(acked, seq);
+    collect();
+  }
+
+  /// Stops waiting for peer's acknowledgements.
+  void forget(const _Peer &peer) {
+    peers.erase(peer);
+    collect();
+  }
+
+private:
+  void collect() {
+    if (peers.empty())
+      return;
+
+    auto acked = std::min_element(peers.begin(), peers.end(),
+                                  [](const auto &l, const auto &r) {
+                                    return l.second < r.second;
+                                  })
+                     ->second;
+    for (; base < acked && !deltas.empty(); ++base)
+      deltas.pop_front();
+  }
+
+  std::deque<_Delta> deltas;
+  seq_type base = 0;
+  std::unordered_map<_Peer, seq_type> peers;
+};
+
+} // namespace crdt.
+
+#endif // DELTA_BUFFER_H
@@ -0,0 +1,216 @@
+#ifndef DENSE_MAP_H
+#define DENSE_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <actor_registry.hpp>
+#include <crdt_traits.hpp>
+#include <version_vector.hpp>
+
+namespace crdt {
+
+template <typename T>
+concept dense_key = std::is_enum_v<T> || std::is_unsigned_v<T>;
+
+namespace details {
+
+/// Iterator over an array of counters indexed by actor slot, skipping
+/// absent (zero) slots.
+template <typename _Key, bool Const> class counter_iterator {
+  using counter_ptr =
+      std::conditional_t<Const, const std::uint64_t *, std::uint64_t *>;
+  using counter_ref =
+      std::conditional_t<Const, const std::uint64_t &, std::uint64_t &>;
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::pair<const _Key, std::uint64_t>;
+  using reference = std::pair<const _Key, counter_ref>;
+
+  struct pointer {
+    reference ref;
+    constexpr auto operator->() noexcept -> reference * { return &ref; }
+  };
+
+  constexpr counter_iterator() = default;
+  constexpr counter_iterator(counter_ptr base, std::size_t index,
+                             std::size_t extent)
+      : base(base), index(index), extent(extent) {
+    skip_absent();
+  }
+
+  constexpr operator counter_iterator<_Key, true>() const noexcept
+      requires(!Const) {
+    return counter_iterator<_Key, true>(base, index, extent);
+  }
+
+  constexpr auto operator*() const noexcept -> reference {
+    return reference{static_cast<_Key>(index), base[index]};
+  }
+  constexpr auto operator->() const noexcept -> pointer {
+    return pointer{**this};
+  }
+
+  constexpr auto operator++() noexcept -> counter_iterator & {
+    ++index;
+    skip_absent();
+    return *this;
+  }
+  constexpr auto operator++(int) noexcept -> counter_iterator {
+    auto copy = *this;
+    ++*this;
+    return copy;
+  }
+
+  constexpr auto operator==(const counter_iterator &other) const noexcept
+      -> bool {
+    return index == other.index;
+  }
+
+  /// Position in the counter array.
+  constexpr auto slot() const noexcept -> std::size_t { return index; }
+
+private:
+  constexpr void skip_absent() noexcept {
+    while (index < extent && base[index] == 0)
+      ++index;
+  }
+
+  counter_ptr base = nullptr;
+  std::size_t index = 0;
+  std::size_t extent = 0;
+};
+
+} // namespace details
+
+/// Clock storage indexed directly by a dense actor id (see actor_registry).
+/// A zero counter means the actor is absent, so iteration only visits
+/// non-zero slots and version_vector can run its operations as
+/// element-wise kernels over the counter array.
+template <dense_key _Key = actor_id> class dense_map {
+public:
+  using key_type = _Key;
+  using mapped_type = std::uint64_t;
+  using value_type = std::pair<const _Key, std::uint64_t>;
+  using size_type = std::size_t;
+  using iterator = details::counter_iterator<_Key, false>;
+  using const_iterator = details::counter_iterator<_Key, true>;
+
+  dense_map() = default;
+  dense_map(const dense_map &) = default;
+  dense_map(dense_map &&) = default;
+  dense_map &operator=(const dense_map &) = default;
+  dense_map &operator=(dense_map &&) = default;
+
+  /// Equal when every actor has the same counter, trailing zero slots
+  /// do not matter.
+  auto operator==(const dense_map &other) const noexcept -> bool {
+    auto common = std::min(extent(), other.extent());
+    auto zero = [](std::uint64_t c) { return c == 0; };
+    return std::equal(counters.begin(), counters.begin() + common,
+                      other.counters.begin()) &&
+           std::all_of(counters.begin() + common, counters.end(), zero) &&
+           std::all_of(other.counters.begin() + common, other.counters.end(),
+                       zero);
+  }
+
+  auto begin() noexcept -> iterator { return iterator(data(), 0, extent()); }
+  auto end() noexcept -> iterator {
+    return iterator(data(), extent(), extent());
+  }
+  auto begin() const noexcept -> const_iterator {
+    return const_iterator(data(), 0, extent());
+  }
+  auto end() const noexcept -> const_iterator {
+    return const_iterator(data(), extent(), extent());
+  }
+  auto cbegin() const noexcept -> const_iterator { return begin(); }
+  auto cend() const noexcept -> const_iterator { return end(); }
+
+  auto size() const noexcept -> size_type {
+    return counters.size() -
+           std::count(counters.begin(), counters.end(), std::uint64_t{0});
+  }
+  auto empty() const noexcept -> bool {
+    return std::all_of(counters.begin(), counters.end(),
+                       [](std::uint64_t c) { return c == 0; });
+  }
+  void clear() noexcept { counters.clear(); }
+
+  auto find(const _Key &key) noexcept -> iterator {
+    auto i = slot(key);
+    return i < extent() && counters[i] != 0 ? iterator(data(), i, extent())
+                                            : end();
+  }
+  auto find(const _Key &key) const noexcept -> const_iterator {
+    auto i = slot(key);
+    return i < extent() && counters[i] != 0
+               ? const_iterator(data(), i, extent())
+               : end();
+  }
+
+  auto contains(const _Key &key) const noexcept -> bool {
+    auto i = slot(key);
+    return i < extent() && counters[i] != 0;
+  }
+
+  auto operator[](const _Key &key) -> std::uint64_t & {
+    auto i = slot(key);
+    grow(i + 1);
+    return counters[i];
+  }
+
+  auto emplace(const _Key &key, std::uint64_t counter)
+      -> std::pair<iterator, bool> {
+    if (auto it = find(key); it != end())
+      return {it, false};
+    (*this)[key] = counter;
+    return {iterator(data(), slot(key), extent()), true};
+  }
+
+  auto erase(const_iterator pos) noexcept -> iterator {
+    auto i = pos.slot();
+    counters[i] = 0;
+    return iterator(data(), i, extent());
+  }
+
+  auto erase(const _Key &key) noexcept -> size_type {
+    if (auto i = slot(key); i < extent() && counters[i] != 0) {
+      counters[i] = 0;
+      return 1;
+    }
+    return 0;
+  }
+
+  /// Number of addressable slots, i.e. one past the highest actor ever set.
+  auto extent() const noexcept -> size_type { return counters.size(); }
+  void grow(size_type n) {
+    if (n > counters.size())
+      counters.resize(n, 0);
+  }
+  auto data() noexcept -> std::uint64_t * { return counters.data(); }
+  auto data() const noexcept -> const std::uint64_t * {
+    return counters.data();
+  }
+
+private:
+  static constexpr auto slot(const _Key &key) noexcept -> size_type {
+    return static_cast<size_type>(key);
+  }
+
+  std::vector<std::uint64_t> counters;
+};
+
+template <dense_key _Key = actor_id>
+using dense_version_vector = version_vector<_Key, dense_map<_Key>>;
+
+} // namespace crdt.
+
+#endif // DENSE_MAP_H
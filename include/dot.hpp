@@ -13,7 +13,7 @@ template <actor_type A> struct dot {
   std::uint64_t counter;
 
   dot() = default;
-  dot(A a, std::uint64_t counter) : actor(a), counter(counter) {}
+  constexpr dot(A a, std::uint64_t counter) : actor(a), counter(counter) {}
   dot(dot &&) = default;
   dot(dot &dot) = delete;
   auto operator<=>(const dot<A> &b) const = default;
@@ -21,7 +21,8 @@ template <actor_type A> struct dot {
   auto clone() const noexcept -> dot<A> { return ++(*this); };
 };
 
-template <actor_type A> auto operator++(const dot<A> &a) noexcept -> dot<A> {
+template <actor_type A>
+constexpr auto operator++(const dot<A> &a) noexcept -> dot<A> {
   return dot<A>(a.actor, (a.counter + 1));
 }
 
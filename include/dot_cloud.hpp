@@ -0,0 +1,147 @@
+#ifndef DOT_CLOUD_H
+#define DOT_CLOUD_H
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include <crdt_traits.hpp>
+#include <dot.hpp>
+#include <version_vector.hpp>
+
+namespace crdt {
+
+/// Dots seen past a gap in the contiguous prefix a version_vector records.
+/// The vector and the cloud together form the causal context of a replica,
+/// so ops delivered out of order are remembered instead of rejected, and
+/// compact() folds them back into the vector once the gaps are filled.
+template <actor_type _Actor> struct dot_cloud {
+  std::unordered_map<_Actor, std::set<std::uint64_t>> dots;
+
+  bool operator==(const dot_cloud<_Actor> &) const noexcept = default;
+
+  auto empty() const noexcept -> bool { return dots.empty(); }
+
+  auto contains(const dot<_Actor> &d) const noexcept -> bool {
+    auto it = dots.find(d.actor);
+    return it != dots.end() && it->second.contains(d.counter);
+  }
+
+  void insert(const dot<_Actor> &d) { dots[d.actor].insert(d.counter); }
+
+  void merge(const dot_cloud<_Actor> &other) {
+    for (const auto &[actor, counters] : other.dots)
+      dots[actor].insert(counters.begin(), counters.end());
+  }
+
+  void merge(dot_cloud<_Actor> &&other) {
+    if (dots.empty()) {
+      dots = std::move(other.dots);
+      return;
+    }
+    for (auto &[actor, counters] : other.dots)
+      dots[actor].merge(counters);
+  }
+
+  /// Whether the context made of clock and this cloud has seen d.
+  template <iterable_assiative_type<_Actor, std::uint64_t> _Map>
+  auto covers(const version_vector<_Actor, _Map> &clock,
+              const dot<_Actor> &d) const noexcept -> bool {
+    return clock.get(d.actor) >= d.counter || contains(d);
+  }
+
+  /// Whether every dot of v has been seen by the context of clock and this
+  /// cloud.
+  template <iterable_assiative_type<_Actor, std::uint64_t> _Map,
+            iterable_assiative_type<_Actor, std::uint64_t> _Other>
+  auto dominates(const version_vector<_Actor, _Map> &clock,
+                 const version_vector<_Actor, _Other> &v) const noexcept
+      -> bool {
+    for (const auto &[actor, counter] : v.dots)
+      if (!covers(clock, dot(actor, counter)))
+        return false;
+    return true;
+  }
+
+  /// Copy of v without the dots the context of clock and this cloud has seen.
+  /// v may use another dots backend than clock, e.g. an inline member clock.
+  template <iterable_assiative_type<_Actor, std::uint64_t> _Other,
+            iterable_assiative_type<_Actor, std::uint64_t> _Map>
+  auto clone_without(version_vector<_Actor, _Other> v,
+                     const version_vector<_Actor, _Map> &clock) const
+      -> version_vector<_Actor, _Other> {
+    constexpr auto same_backend = std::same_as<_Other, _Map>;
+    if constexpr (same_backend)
+      v.reset_remove(clock);
+    if (same_backend && empty())
+      return v;
+    for (auto it = v.dots.begin(); it != v.dots.end();) {
+      if ((!same_backend && clock.get(it->first) >= it->second) ||
+          contains(dot(it->first, it->second)))
+        it = v.dots.erase(it);
+      else
+        ++it;
+    }
+    return v;
+  }
+
+  /// Records d in the context of clock: it extends clock when it is the
+  /// next counter of its actor and lands in the cloud otherwise.
+  template <iterable_assiative_type<_Actor, std::uint64_t> _Map>
+  void witness(version_vector<_Actor, _Map> &clock, const dot<_Actor> &d) {
+    if (covers(clock, d))
+      return;
+    if (d.counter == clock.get(d.actor) + 1) {
+      clock.apply(d);
+      if (auto it = dots.find(d.actor); it != dots.end())
+        compact(clock, it);
+    } else {
+      insert(d);
+    }
+  }
+
+  /// Moves every dot that became contiguous with clock into it and drops
+  /// the ones clock already covers.
+  template <iterable_assiative_type<_Actor, std::uint64_t> _Map>
+  void compact(version_vector<_Actor, _Map> &clock) {
+    for (auto it = dots.begin(); it != dots.end();)
+      it = compact(clock, it);
+  }
+
+  /// Drops the dots clock covers, mirrors version_vector::reset_remove.
+  template <iterable_assiative_type<_Actor, std::uint64_t> _Map>
+  void reset_remove(const version_vector<_Actor, _Map> &clock) {
+    for (auto it = dots.begin(); it != dots.end();) {
+      auto &counters = it->second;
+      counters.erase(counters.begin(),
+                     counters.upper_bound(clock.get(it->first)));
+      it = counters.empty() ? dots.erase(it) : std::next(it);
+    }
+  }
+
+private:
+  using iterator =
+      typename std::unordered_map<_Actor, std::set<std::uint64_t>>::iterator;
+
+  template <iterable_assiative_type<_Actor, std::uint64_t> _Map>
+  auto compact(version_vector<_Actor, _Map> &clock, iterator it) -> iterator {
+    auto &counters = it->second;
+    auto next = clock.get(it->first);
+    auto seen = counters.begin();
+    for (; seen != counters.end() && *seen <= next + 1; ++seen)
+      next = std::max(next, *seen);
+    counters.erase(counters.begin(), seen);
+
+    if (next > clock.get(it->first))
+      clock.apply(dot(it->first, next));
+    return counters.empty() ? dots.erase(it) : std::next(it);
+  }
+};
+
+} // namespace crdt.
+
+#endif // DOT_CLOUD_H
@@ -0,0 +1,425 @@
+#ifndef DOT_ORSET_H
+#define DOT_ORSET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <system_error>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <actor_registry.hpp>
+#include <context.hpp>
+#include <crdt_traits.hpp>
+#include <deferred_removals.hpp>
+#include <dot.hpp>
+#include <dot_cloud.hpp>
+#include <small_vector.hpp>
+#include <version_vector.hpp>
+
+namespace crdt {
+
+/// Add-wins set over a dot store. Instead of a clock per member, a member
+/// keeps the latest dot of every actor that added it, every dot is indexed
+/// back to its members, and the causal context (clock and dot cloud) exists
+/// once per replica. A dot the other replica's context has seen but its
+/// store lacks was removed there, so merge is the difference of the two dot
+/// sets. Ops and merge behave as orswot's.
+///
+/// Actors are interned into replica-local actor_id's, so a stored dot is an
+/// id and a counter, and the index names members by the key held in entries
+/// instead of a copy of it.
+template <actor_type _Key, actor_type _Actor,
+          set_type<_Key> _Deferred_set_type = std::unordered_set<_Key>,
+          iterable_assiative_type<version_vector<_Actor>, _Deferred_set_type>
+              _Deferred_map =
+                  std::unordered_map<version_vector<_Actor>, _Deferred_set_type>>
+struct dot_orset {
+  using vector_clock = version_vector<_Actor>;
+  using cloud_type = dot_cloud<_Actor>;
+  using deferred_set = _Deferred_set_type;
+  using deferred_store =
+      deferred_removals<_Actor, _Key, _Deferred_set_type, _Deferred_map>;
+  using dot_orset_type =
+      dot_orset<_Key, _Actor, _Deferred_set_type, _Deferred_map>;
+
+  struct member_dot {
+    std::uint64_t counter = 0;
+    actor_id actor{};
+  };
+  /// Latest counter of every actor that added a member, rarely more than a
+  /// few of them.
+  using member_dots = small_vector<member_dot, 3>;
+
+  /// Stored dots of one actor sorted by counter, each naming its member by
+  /// the key in entries. Slots of dots dropped since are cleared rather
+  /// than erased, and swept once they make up half of the vector.
+  struct actor_dots {
+    std::vector<std::pair<std::uint64_t, const _Key *>> dots;
+    std::size_t cleared = 0;
+  };
+
+  vector_clock clock;
+  /// Dots applied ahead of clock, see dot_cloud.
+  cloud_type cloud;
+  std::unordered_map<_Key, member_dots> entries;
+  /// Interned actors, actors[index(id)] being the actor of id.
+  std::vector<_Actor> actors;
+  std::unordered_map<_Actor, actor_id> actor_ids;
+  /// Stored dots by actor_id.
+  std::vector<actor_dots> index;
+  deferred_store deferred;
+
+  dot_orset() = default;
+
+  /// The index points into entries, so a copy repoints it to its own keys.
+  dot_orset(const dot_orset_type &other)
+      : clock(other.clock), cloud(other.cloud), entries(other.entries),
+        actors(other.actors), actor_ids(other.actor_ids),
+        deferred(other.deferred) {
+    index.reserve(other.index.size());
+    for (const auto &theirs : other.index) {
+      auto &ours = index.emplace_back();
+      ours.dots.reserve(theirs.dots.size() - theirs.cleared);
+      for (const auto &[counter, key] : theirs.dots)
+        if (key != nullptr)
+          ours.dots.emplace_back(counter, &entries.find(*key)->first);
+    }
+  }
+
+  /// Moving entries keeps its nodes, and the index stays valid.
+  dot_orset(dot_orset_type &&) = default;
+
+  auto operator==(const dot_orset_type &other) const noexcept -> bool {
+    if (entries.size() != other.entries.size())
+      return false;
+    for (const auto &e : entries)
+      if (!other.entries.contains(e.first))
+        return false;
+    return true;
+  }
+
+  struct Add {
+    dot<_Actor> d;
+    std::vector<_Key> members;
+  };
+
+  struct Rm {
+    version_vector<_Actor> clock;
+    std::vector<_Key> members;
+  };
+
+  using Op = std::variant<Add, Rm>;
+
+  auto validate_op(const Op &) const noexcept
+      -> std::optional<std::error_condition> {
+    return std::nullopt;
+  }
+
+  void apply(const Op &op) noexcept {
+    apply_op(op);
+    deferred.release(clock);
+  }
+
+  /// Applies ops in one pass, releasing deferred removals once at the end.
+  void apply(std::span<const Op> ops) noexcept {
+    for (const auto &op : ops)
+      apply_op(op);
+    deferred.release(clock);
+  }
+
+  void apply_op(const Op &op) noexcept {
+    std::visit(overloaded{
+                   [this](const Add &add) {
+                     if (cloud.covers(clock, add.d)) {
+                       return;
+                     }
+
+                     auto id = intern(add.d.actor);
+                     for (const auto &member : add.members) {
+                       insert(member, id, add.d.counter);
+                       deferred.for_each(member, [&](const auto &rm_clock) {
+                         remove_member(member, rm_clock);
+                       });
+                     }
+
+                     cloud.witness(clock, add.d);
+                   },
+                   [this](const Rm &rm) { apply_rm(rm.members, rm.clock); },
+               },
+               op);
+  }
+
+  /// Re-applies every pending removal, needed once dots arrive through a
+  /// merge rather than one add at a time.
+  void apply_deferred() {
+    deferred.for_each([this](const auto &vclock, const auto &members) {
+      for (const auto &member : members)
+        remove_member(member, vclock);
+    });
+    deferred.release(clock);
+  }
+
+  template <typename _Members>
+  void apply_rm(const _Members &members, const vector_clock &vclock) {
+    for (const auto &member : members)
+      remove_member(member, vclock);
+
+    deferred.defer(clock, vclock, members);
+  }
+
+  /// Drops the dots of member vclock has seen.
+  void remove_member(const _Key &member, const vector_clock &vclock) {
+    auto entry = entries.find(member);
+    if (entry == entries.end())
+      return;
+
+    auto &dots = entry->second;
+    for (auto it = dots.begin(); it != dots.end();) {
+      if (it->counter <= vclock.get(actor_of(it->actor))) {
+        unindex(it->actor, it->counter, &entry->first);
+        it = dots.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (dots.empty())
+      entries.erase(entry);
+  }
+
+  void reset_remove(const version_vector<_Actor> &vclock) {
+    clock.reset_remove(vclock);
+    cloud.reset_remove(vclock);
+
+    for (std::uint32_t i = 0; i < index.size(); ++i) {
+      auto &[dots, cleared] = index[i];
+      auto last = std::ranges::upper_bound(
+          dots, vclock.get(actors[i]), {},
+          &std::pair<std::uint64_t, const _Key *>::first);
+      for (auto d = dots.begin(); d != last; ++d) {
+        if (d->second == nullptr)
+          --cleared;
+        else
+          erase_dot(entries.find(*d->second), actor_id{i});
+      }
+      dots.erase(dots.begin(), last);
+    }
+
+    deferred.reset_remove(vclock, clock);
+  }
+
+  auto validate_merge(const dot_orset_type &) const noexcept
+      -> std::optional<std::error_condition> {
+    return std::nullopt;
+  }
+
+  void merge(const dot_orset_type &other) {
+    // dots other's context has seen but its store lacks were removed there.
+    // A member's entry goes with its last dot, after every other removal
+    // naming it.
+    std::vector<std::tuple<actor_id, std::uint64_t, const _Key *>> removed;
+    for (std::uint32_t i = 0; i < index.size(); ++i) {
+      auto seen = other.seen_by(actors[i]);
+      auto theirs = other.actor_ids.find(actors[i]);
+      for (const auto &[counter, member] : index[i].dots)
+        if (member != nullptr && seen(counter) &&
+            (theirs == other.actor_ids.end() ||
+             !other.stores(*member, theirs->second, counter)))
+          removed.emplace_back(actor_id{i}, counter, member);
+    }
+    for (const auto &[id, counter, member] : removed) {
+      unindex(id, counter, member);
+      erase_dot(entries.find(*member), id);
+    }
+
+    // dots missing from our context are new to us.
+    for (std::uint32_t i = 0; i < other.index.size(); ++i) {
+      auto seen = seen_by(other.actors[i]);
+      std::optional<actor_id> id;
+      for (const auto &[counter, member] : other.index[i].dots) {
+        if (member == nullptr || seen(counter))
+          continue;
+        if (!id)
+          id = intern(other.actors[i]);
+        insert(*member, *id, counter);
+      }
+    }
+
+    other.deferred.for_each([this](const auto &rm_clock, const auto &members) {
+      apply_rm(members, rm_clock);
+    });
+
+    clock.merge(other.clock);
+    cloud.merge(other.cloud);
+    cloud.compact(clock);
+    apply_deferred();
+  }
+
+  auto contains(const _Key &member) const noexcept
+      -> read_context<bool, _Actor> {
+    if (auto it = entries.find(member); it != entries.end())
+      return read_context(clock, member_clock(it->second), true);
+    return read_context(clock, vector_clock(), false);
+  }
+
+  auto read() const noexcept -> read_context<deferred_set, _Actor> {
+    deferred_set val;
+    for (const auto &[member, dots] : entries)
+      val.insert(member);
+    return read_context(clock, clock, val);
+  }
+
+  /// Members read in place from entries, see read_view.
+  auto members() const noexcept {
+    return read_view(clock, std::views::keys(entries));
+  }
+
+  auto read_ctx() const noexcept -> read_context<deferred_set, _Actor> {
+    return read_context(clock, clock, deferred_set());
+  }
+
+  auto add(add_context<_Actor> ctx, _Key member) noexcept -> Op {
+    return Add{std::move(ctx.dot), {member}};
+  }
+
+  /// Adds every member of [first, last) under a single dot.
+  template <std::input_iterator _It>
+  auto add(add_context<_Actor> ctx, _It first, _It last) noexcept -> Op {
+    return Add{std::move(ctx.dot), {first, last}};
+  }
+
+  /// Adds member locally and returns the delta holding just the new dot.
+  auto add(const _Actor &actor, const _Key &member) noexcept
+      -> dot_orset_type {
+    auto op = add(read_ctx().derive_add_context(actor), member);
+    dot_orset_type delta;
+    delta.apply(op);
+    apply(op);
+    return delta;
+  }
+
+  auto rm(remove_context<_Actor> ctx, _Key member) noexcept -> Op {
+    return Rm{ctx.vector, {member}};
+  }
+
+  template <std::input_iterator _It>
+  auto rm(remove_context<_Actor> ctx, _It first, _It last) noexcept -> Op {
+    return Rm{std::move(ctx.vector), {first, last}};
+  }
+
+  /// Removes member locally and returns the delta removing the dots it was
+  /// observed with, empty when member is absent.
+  auto rm(const _Actor &_, const _Key &member) noexcept -> dot_orset_type {
+    dot_orset_type delta;
+    if (auto it = entries.find(member); it != entries.end()) {
+      auto op = rm(remove_context<_Actor>{member_clock(it->second)}, member);
+      delta.apply(op);
+      apply(op);
+    }
+    return delta;
+  }
+
+private:
+  auto member_clock(const member_dots &dots) const -> vector_clock {
+    vector_clock vclock;
+    for (const auto &[counter, id] : dots)
+      vclock.apply(dot(actor_of(id), counter));
+    return vclock;
+  }
+
+  auto actor_of(actor_id id) const noexcept -> const _Actor & {
+    return actors[crdt::index(id)];
+  }
+
+  auto intern(const _Actor &actor) -> actor_id {
+    auto [it, fresh] = actor_ids.try_emplace(
+        actor, actor_id{static_cast<std::uint32_t>(actors.size())});
+    if (fresh) {
+      actors.push_back(actor);
+      index.emplace_back();
+    }
+    return it->second;
+  }
+
+  /// Whether the context has seen a counter of actor, looking actor up once
+  /// for all the counters it is asked about.
+  auto seen_by(const _Actor &actor) const {
+    auto cloud_dots = cloud.dots.find(actor);
+    const auto *counters =
+        cloud_dots == cloud.dots.end() ? nullptr : &cloud_dots->second;
+    return [upto = clock.get(actor), counters](std::uint64_t counter) {
+      return counter <= upto ||
+             (counters != nullptr && counters->contains(counter));
+    };
+  }
+
+  auto stores(const _Key &member, actor_id id, std::uint64_t counter) const
+      -> bool {
+    auto entry = entries.find(member);
+    if (entry == entries.end())
+      return false;
+    auto it = std::ranges::find(entry->second, id, &member_dot::actor);
+    return it != entry->second.end() && it->counter == counter;
+  }
+
+  /// Stores the dot of id for member unless a later one is stored.
+  void insert(const _Key &member, actor_id id, std::uint64_t counter) {
+    auto entry = entries.try_emplace(member).first;
+    auto &dots = entry->second;
+    auto it = std::ranges::find(dots, id, &member_dot::actor);
+    if (it == dots.end()) {
+      dots.push_back(member_dot{counter, id});
+    } else if (it->counter < counter) {
+      unindex(id, it->counter, &entry->first);
+      it->counter = counter;
+    } else {
+      return;
+    }
+
+    // counters of an actor mostly arrive in order and are appended.
+    auto &slots = index[crdt::index(id)].dots;
+    auto pos = slots.empty() || slots.back().first <= counter
+                   ? slots.end()
+                   : std::ranges::upper_bound(
+                         slots, counter, {},
+                         &std::pair<std::uint64_t, const _Key *>::first);
+    slots.emplace(pos, counter, &entry->first);
+  }
+
+  /// Removes the dot of id from the member at entry, leaving the index
+  /// alone.
+  void erase_dot(typename std::unordered_map<_Key, member_dots>::iterator entry,
+                 actor_id id) {
+    auto &dots = entry->second;
+    dots.erase(std::ranges::find(dots, id, &member_dot::actor));
+    if (dots.empty())
+      entries.erase(entry);
+  }
+
+  void unindex(actor_id id, std::uint64_t counter, const _Key *member) {
+    auto &[slots, cleared] = index[crdt::index(id)];
+    auto [first, last] = std::ranges::equal_range(
+        slots, counter, {}, &std::pair<std::uint64_t, const _Key *>::first);
+    std::ranges::find(first, last, member,
+                      &std::pair<std::uint64_t, const _Key *>::second)
+        ->second = nullptr;
+    if (++cleared * 2 >= slots.size()) {
+      std::erase_if(slots, [](const auto &slot) {
+        return slot.second == nullptr;
+      });
+      cleared = 0;
+    }
+  }
+};
+
+} // namespace crdt.
+
+#endif // DOT_ORSET_H
@@ -0,0 +1,130 @@
+#ifndef FLAT_MAP_H
+#define FLAT_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include <small_vector.hpp>
+
+namespace crdt {
+
+/// Associative container over a sorted contiguous array of key/value pairs.
+/// Up to N entries live inline, so small clocks never touch the heap.
+template <std::default_initializable _Key, std::default_initializable _Tp,
+          std::size_t N = 8, typename _Compare = std::less<_Key>>
+class flat_map {
+public:
+  using key_type = _Key;
+  using mapped_type = _Tp;
+  using value_type = std::pair<_Key, _Tp>;
+  using key_compare = _Compare;
+  using size_type = std::size_t;
+  using storage_type = small_vector<value_type, N>;
+  using iterator = typename storage_type::iterator;
+  using const_iterator = typename storage_type::const_iterator;
+
+  flat_map() = default;
+  flat_map(const flat_map &) = default;
+  flat_map(flat_map &&) = default;
+  flat_map &operator=(const flat_map &) = default;
+  flat_map &operator=(flat_map &&) = default;
+
+  auto operator==(const flat_map &) const noexcept -> bool = default;
+
+  auto begin() noexcept -> iterator { return items.begin(); }
+  auto end() noexcept -> iterator { return items.end(); }
+  auto begin() const noexcept -> const_iterator { return items.begin(); }
+  auto end() const noexcept -> const_iterator { return items.end(); }
+  auto cbegin() const noexcept -> const_iterator { return items.cbegin(); }
+  auto cend() const noexcept -> const_iterator { return items.cend(); }
+
+  auto size() const noexcept -> size_type { return items.size(); }
+  auto empty() const noexcept -> bool { return items.empty(); }
+  void clear() noexcept { items.clear(); }
+  void reserve(size_type n) { items.reserve(n); }
+
+  auto key_comp() const noexcept -> key_compare { return key_compare{}; }
+
+  auto lower_bound(const _Key &key) noexcept -> iterator {
+    return std::lower_bound(begin(), end(), key, entry_less{});
+  }
+  auto lower_bound(const _Key &key) const noexcept -> const_iterator {
+    return std::lower_bound(begin(), end(), key, entry_less{});
+  }
+
+  auto find(const _Key &key) noexcept -> iterator {
+    auto it = lower_bound(key);
+    return it != end() && !key_compare{}(key, it->first) ? it : end();
+  }
+  auto find(const _Key &key) const noexcept -> const_iterator {
+    auto it = lower_bound(key);
+    return it != end() && !key_compare{}(key, it->first) ? it : end();
+  }
+
+  auto contains(const _Key &key) const noexcept -> bool {
+    return find(key) != end();
+  }
+
+  auto operator[](const _Key &key) -> _Tp & {
+    auto it = lower_bound(key);
+    if (it == end() || key_compare{}(key, it->first))
+      it = items.emplace(it, key, _Tp{});
+    return it->second;
+  }
+
+  template <typename... Args>
+  auto emplace(const _Key &key, Args &&...args) -> std::pair<iterator, bool> {
+    auto it = lower_bound(key);
+    if (it != end() && !key_compare{}(key, it->first))
+      return {it, false};
+    return {items.emplace(it, key, _Tp(std::forward<Args>(args)...)), true};
+  }
+
+  auto insert(const value_type &value) -> std::pair<iterator, bool> {
+    return emplace(value.first, value.second);
+  }
+
+  /// Inserts before hint when it is the right position, which makes
+  /// building a map from an already sorted sequence linear.
+  template <typename... Args>
+  auto emplace_hint(const_iterator hint, const _Key &key, Args &&...args)
+      -> iterator {
+    if ((hint == cend() || key_compare{}(key, hint->first)) &&
+        (hint == cbegin() || key_compare{}((hint - 1)->first, key)))
+      return items.emplace(hint, key, _Tp(std::forward<Args>(args)...));
+    return emplace(key, std::forward<Args>(args)...).first;
+  }
+
+  auto insert(const_iterator hint, const value_type &value) -> iterator {
+    return emplace_hint(hint, value.first, value.second);
+  }
+
+  auto erase(const_iterator pos) noexcept -> iterator {
+    return items.erase(pos);
+  }
+  auto erase(iterator pos) noexcept -> iterator { return items.erase(pos); }
+
+  auto erase(const _Key &key) noexcept -> size_type {
+    if (auto it = find(key); it != end()) {
+      items.erase(it);
+      return 1;
+    }
+    return 0;
+  }
+
+private:
+  struct entry_less {
+    auto operator()(const value_type &entry, const _Key &key) const noexcept
+        -> bool {
+      return key_compare{}(entry.first, key);
+    }
+  };
+
+  storage_type items;
+};
+
+} // namespace crdt.
+
+#endif // FLAT_MAP_H
@@ -0,0 +1,373 @@
+#ifndef FLAT_TABLE_H
+#define FLAT_TABLE_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <crdt_traits.hpp>
+#include <flat_map.hpp>
+#include <simd.hpp>
+#include <version_vector.hpp>
+
+namespace crdt {
+
+/// Open addressing hash map keeping its entries inline in one array of
+/// slots. A control byte per slot holds 7 bits of the key's hash, or marks
+/// the slot empty or erased; slots are probed 16 control bytes at a time, so
+/// a lookup usually touches one group of control bytes and the one slot
+/// holding the key. Hashes are mixed first, so that the identity hash of
+/// integers spreads over the groups and tags. Used as the entries map of
+/// orswot, a member costs one slot instead of a node. Members' clocks then
+/// live in the slot as well when they are an inline_clock, or when
+/// dots_map_traits selects an inline backend such as flat_map for the actor
+/// type.
+///
+/// Erasing only marks the slot, so iterators to other entries stay valid and
+/// erase(it) returns the next entry in iteration order. Inserting may rehash
+/// and invalidates every iterator.
+template <std::default_initializable _Key, std::default_initializable _Tp,
+          typename _Hash = std::hash<_Key>,
+          typename _KeyEqual = std::equal_to<_Key>>
+class flat_table {
+  static constexpr std::size_t width = details::simd::group::width;
+  static constexpr std::int8_t empty_tag = -128;
+  static constexpr std::int8_t erased_tag = -2;
+
+  template <typename K>
+  static constexpr bool transparent =
+      requires { typename _Hash::is_transparent; } &&
+      requires { typename _KeyEqual::is_transparent; } &&
+      std::regular_invocable<const _Hash &, const K &>;
+
+public:
+  using key_type = _Key;
+  using mapped_type = _Tp;
+  using value_type = std::pair<_Key, _Tp>;
+  using size_type = std::size_t;
+  using hasher = _Hash;
+  using key_equal = _KeyEqual;
+
+  template <bool Const> class basic_iterator {
+  public:
+    using table_pointer =
+        std::conditional_t<Const, const flat_table *, flat_table *>;
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = flat_table::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<Const, const value_type &, value_type &>;
+    using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+
+    basic_iterator() = default;
+    basic_iterator(table_pointer table, size_type slot)
+        : table(table), slot(slot) {}
+    template <bool Other>
+      requires(Const && !Other)
+    basic_iterator(const basic_iterator<Other> &other)
+        : table(other.table), slot(other.slot) {}
+
+    auto operator*() const -> reference { return table->slots[slot]; }
+    auto operator->() const -> pointer { return &table->slots[slot]; }
+
+    auto operator++() -> basic_iterator & {
+      slot = table->next_full(slot + 1);
+      return *this;
+    }
+    auto operator++(int) -> basic_iterator {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    friend auto operator==(const basic_iterator &l,
+                           const basic_iterator &r) noexcept -> bool {
+      return l.slot == r.slot;
+    }
+
+  private:
+    friend class flat_table;
+    template <bool> friend class basic_iterator;
+
+    table_pointer table = nullptr;
+    size_type slot = 0;
+  };
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  flat_table() = default;
+
+  flat_table(const flat_table &other) : flat_table() {
+    allocate(other.capacity);
+    ctrl = other.ctrl;
+    for (size_type i = 0; i < capacity; ++i)
+      if (ctrl[i] >= 0)
+        std::construct_at(slots + i, other.slots[i]);
+    count = other.count;
+    erased = other.erased;
+  }
+
+  flat_table(flat_table &&other) noexcept { swap(other); }
+
+  flat_table &operator=(flat_table other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~flat_table() {
+    destroy_all();
+    deallocate();
+  }
+
+  void swap(flat_table &other) noexcept {
+    std::swap(ctrl, other.ctrl);
+    std::swap(slots, other.slots);
+    std::swap(capacity, other.capacity);
+    std::swap(count, other.count);
+    std::swap(erased, other.erased);
+  }
+
+  auto operator==(const flat_table &other) const -> bool
+    requires std::equality_comparable<_Tp>
+  {
+    if (size() != other.size())
+      return false;
+    for (const auto &[key, value] : *this) {
+      auto it = other.find(key);
+      if (it == other.end() || !(it->second == value))
+        return false;
+    }
+    return true;
+  }
+
+  auto begin() noexcept -> iterator { return iterator(this, next_full(0)); }
+  auto end() noexcept -> iterator { return iterator(this, capacity); }
+  auto begin() const noexcept -> const_iterator {
+    return const_iterator(this, next_full(0));
+  }
+  auto end() const noexcept -> const_iterator {
+    return const_iterator(this, capacity);
+  }
+  auto cbegin() const noexcept -> const_iterator { return begin(); }
+  auto cend() const noexcept -> const_iterator { return end(); }
+
+  auto size() const noexcept -> size_type { return count; }
+  auto empty() const noexcept -> bool { return count == 0; }
+
+  void clear() noexcept {
+    destroy_all();
+    std::fill(ctrl.begin(), ctrl.end(), empty_tag);
+    count = 0;
+    erased = 0;
+  }
+
+  /// Makes room for n entries without rehashing.
+  void reserve(size_type n) {
+    if (n > max_load(capacity))
+      rehash(capacity_for(n));
+  }
+
+  auto find(const _Key &key) noexcept -> iterator {
+    return iterator(this, locate(key));
+  }
+  auto find(const _Key &key) const noexcept -> const_iterator {
+    return const_iterator(this, locate(key));
+  }
+
+  /// Lookup by any type the hasher and key_equal accept, when both are
+  /// transparent.
+  template <typename K>
+    requires(!std::same_as<K, _Key> && transparent<K>)
+  auto find(const K &key) noexcept -> iterator {
+    return iterator(this, locate(key));
+  }
+  template <typename K>
+    requires(!std::same_as<K, _Key> && transparent<K>)
+  auto find(const K &key) const noexcept -> const_iterator {
+    return const_iterator(this, locate(key));
+  }
+
+  auto contains(const _Key &key) const noexcept -> bool {
+    return locate(key) != capacity;
+  }
+  template <typename K>
+    requires(!std::same_as<K, _Key> && transparent<K>)
+  auto contains(const K &key) const noexcept -> bool {
+    return locate(key) != capacity;
+  }
+
+  auto operator[](const _Key &key) -> _Tp & {
+    return emplace(key).first->second;
+  }
+
+  template <typename... Args>
+  auto emplace(const _Key &key, Args &&...args) -> std::pair<iterator, bool> {
+    auto hash = hash_of(key);
+    if (auto slot = locate(key, hash); slot != capacity)
+      return {iterator(this, slot), false};
+
+    if (count + erased + 1 > max_load(capacity))
+      rehash(count + 1 > max_load(capacity) / 2 ? capacity_for(count + 1)
+                                                : capacity);
+    auto slot = free_slot(hash);
+    if (ctrl[slot] == erased_tag)
+      --erased;
+    std::construct_at(slots + slot, std::piecewise_construct,
+                      std::forward_as_tuple(key),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+    ctrl[slot] = tag_of(hash);
+    ++count;
+    return {iterator(this, slot), true};
+  }
+
+  auto insert(const value_type &value) -> std::pair<iterator, bool> {
+    return emplace(value.first, value.second);
+  }
+
+  auto erase(const_iterator pos) -> iterator {
+    std::destroy_at(slots + pos.slot);
+    ctrl[pos.slot] = erased_tag;
+    --count;
+    ++erased;
+    return iterator(this, next_full(pos.slot + 1));
+  }
+
+  auto erase(iterator pos) -> iterator { return erase(const_iterator(pos)); }
+
+  auto erase(const _Key &key) -> size_type {
+    if (auto slot = locate(key); slot != capacity) {
+      erase(const_iterator(this, slot));
+      return 1;
+    }
+    return 0;
+  }
+
+private:
+  /// splitmix64 finalizer over the key's hash. The tag is taken from the top
+  /// 7 bits and the group from the low bits, which are then independent.
+  template <typename K> static auto hash_of(const K &key) noexcept
+      -> std::uint64_t {
+    std::uint64_t h = _Hash{}(key);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111eb;
+    return h ^ (h >> 31);
+  }
+
+  static auto tag_of(std::uint64_t hash) noexcept -> std::int8_t {
+    return static_cast<std::int8_t>(hash >> 57);
+  }
+
+  /// Entries a table of the given capacity takes before growing, 7/8 of
+  /// its slots.
+  static auto max_load(size_type capacity) noexcept -> size_type {
+    return capacity - capacity / 8;
+  }
+
+  static auto capacity_for(size_type n) noexcept -> size_type {
+    return std::max(width, std::bit_ceil(n + n / 7 + 1));
+  }
+
+  auto next_full(size_type slot) const noexcept -> size_type {
+    while (slot < capacity && ctrl[slot] < 0)
+      ++slot;
+    return slot;
+  }
+
+  /// Slot holding key, capacity when there is none. Groups are probed
+  /// triangularly, which visits every group of a power of two table.
+  template <typename K>
+  auto locate(const K &key, std::uint64_t hash) const noexcept -> size_type {
+    if (count == 0)
+      return capacity;
+
+    auto groups = capacity / width;
+    auto tag = tag_of(hash);
+    for (std::size_t g = hash & (groups - 1), step = 0;;
+         g = (g + ++step) & (groups - 1)) {
+      const auto *bytes = ctrl.data() + g * width;
+      for (auto m = details::simd::group::match(bytes, tag); m != 0;
+           m &= m - 1) {
+        auto slot = g * width + std::countr_zero(m);
+        if (_KeyEqual{}(slots[slot].first, key))
+          return slot;
+      }
+      if (details::simd::group::match(bytes, empty_tag) != 0 ||
+          step == groups)
+        return capacity;
+    }
+  }
+
+  template <typename K> auto locate(const K &key) const noexcept -> size_type {
+    return locate(key, hash_of(key));
+  }
+
+  /// First empty or erased slot on the probe sequence of hash.
+  auto free_slot(std::uint64_t hash) const noexcept -> size_type {
+    auto groups = capacity / width;
+    for (std::size_t g = hash & (groups - 1), step = 0;;
+         g = (g + ++step) & (groups - 1)) {
+      if (auto m = details::simd::group::match_negative(ctrl.data() +
+                                                        g * width);
+          m != 0)
+        return g * width + std::countr_zero(m);
+    }
+  }
+
+  void rehash(size_type new_capacity) {
+    flat_table grown;
+    grown.allocate(new_capacity);
+    for (size_type i = 0; i < capacity; ++i) {
+      if (ctrl[i] < 0)
+        continue;
+      auto hash = hash_of(slots[i].first);
+      auto slot = grown.free_slot(hash);
+      std::construct_at(grown.slots + slot, std::move(slots[i]));
+      grown.ctrl[slot] = tag_of(hash);
+    }
+    grown.count = count;
+    swap(grown);
+  }
+
+  void allocate(size_type n) {
+    ctrl.assign(n, empty_tag);
+    slots = n == 0 ? nullptr : std::allocator<value_type>().allocate(n);
+    capacity = n;
+  }
+
+  void deallocate() noexcept {
+    if (slots != nullptr)
+      std::allocator<value_type>().deallocate(slots, capacity);
+    slots = nullptr;
+  }
+
+  void destroy_all() noexcept {
+    for (size_type i = 0; i < capacity; ++i)
+      if (ctrl[i] >= 0)
+        std::destroy_at(slots + i);
+  }
+
+  std::vector<std::int8_t> ctrl;
+  value_type *slots = nullptr;
+  size_type capacity = 0;
+  size_type count = 0;
+  size_type erased = 0;
+};
+
+/// Member clock kept whole in a flat_table slot: up to N actors are stored
+/// inline, so adding a member with few writers allocates nothing besides
+/// the table itself.
+template <actor_type _Actor, std::size_t N = 4>
+using inline_clock =
+    version_vector<_Actor, flat_map<_Actor, std::uint64_t, N>>;
+
+} // namespace crdt.
+
+#endif // FLAT_TABLE_H
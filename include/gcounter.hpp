@@ -1,7 +1,7 @@
 #ifndef GCOUNTER_H
 #define GCOUNTER_H
 
-#include <numeric>
+#include <cstdint>
 #include <optional>
 #include <system_error>
 #include <utility>
@@ -13,13 +13,18 @@
 namespace crdt {
 
 template <actor_type A> struct gcounter {
+  using actor_t = A;
   using Op = dot<A>;
 
   gcounter() = default;
-  gcounter(version_vector<A> &&v) noexcept : clock(std::move(v)) {}
+  gcounter(version_vector<A> &&v) noexcept : clock(std::move(v)) {
+    for (const auto &[actor, counter] : clock.dots)
+      total += counter;
+  }
   gcounter(const gcounter &) = default;
   gcounter(gcounter &&) = default;
 
+  gcounter &operator=(const gcounter &) = default;
   gcounter &operator=(gcounter &&) = default;
 
   auto operator<=>(const gcounter<A> &) const noexcept = default;
@@ -29,20 +34,32 @@ template <actor_type A> struct gcounter {
     return std::nullopt;
   }
 
-  void apply(const Op &op) noexcept { clock.apply(op); }
+  void apply(const Op &op) noexcept {
+    if (auto counter = clock.get(op.actor); counter < op.counter)
+      total += op.counter - counter;
+    clock.apply(op);
+  }
 
-  auto validate_merge(const version_vector<A> &) const noexcept
+  auto validate_merge(const gcounter<A> &) const noexcept
       -> std::optional<std::error_condition> {
     return std::nullopt;
   }
 
-  void merge(const gcounter<A> &other) noexcept { clock.merge(other.clock); }
+  void merge(const gcounter<A> &other) noexcept {
+    for (const auto &[actor, counter] : other.clock.dots)
+      if (auto ours = clock.get(actor); ours < counter)
+        total += counter - ours;
+    clock.merge(other.clock);
+  }
 
   void reset_remove(const version_vector<A> &v) noexcept {
+    for (const auto &[actor, counter] : v.dots)
+      if (auto ours = clock.get(actor); ours <= counter)
+        total -= ours;
     clock.reset_remove(v);
   }
 
-  auto inc(const A &a, std::uint32_t steps = 1) noexcept -> gcounter<A> {
+  auto inc(const A &a, std::uint64_t steps = 1) noexcept -> gcounter<A> {
     auto delta = (*this) + std::pair{a, steps};
     apply(delta);
 
@@ -56,19 +73,21 @@ template <actor_type A> struct gcounter {
     return ((*this) + std::pair{a, 1});
   }
 
-  auto operator+(std::pair<A, std::uint32_t> &&a) const noexcept -> dot<A> {
+  auto operator+(std::pair<A, std::uint64_t> &&a) const noexcept -> dot<A> {
     auto steps = a.second;
     steps += clock.get(a.first);
     return dot(a.first, steps);
   }
 
-  auto read() const noexcept -> std::uint32_t {
-    return std::accumulate(
-        clock.dots.begin(), clock.dots.end(), 0,
-        [](std::uint32_t sum, const auto &n) { return sum + n.second; });
-  }
+  /// Counter of a single actor.
+  auto get(const A &a) const noexcept -> std::uint64_t { return clock.get(a); }
+
+  /// Sum of every actor's counter, kept up to date as the clock changes.
+  auto read() const noexcept -> std::uint64_t { return total; }
+
 private:
   version_vector<A> clock;
+  std::uint64_t total = 0;
 };
 
 } // namespace crdt.
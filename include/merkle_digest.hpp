@@ -0,0 +1,147 @@
+#ifndef MERKLE_DIGEST_H
+#define MERKLE_DIGEST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace crdt {
+
+/// Hash tree over the entries of a replica. Entries are spread over
+/// fanout^depth buckets by the hash of their key, a bucket holds the sum of
+/// the hashes of its entries and every inner node the sum of its children,
+/// so the tree is independent of the order entries are visited in and an
+/// entry is added or removed in O(depth). Two replicas find the buckets they
+/// disagree on by comparing the tree level by level, only descending into
+/// nodes whose hashes differ.
+class merkle_digest {
+public:
+  static constexpr unsigned fanout_bits = 4;
+  static constexpr std::size_t fanout = std::size_t{1} << fanout_bits;
+  static constexpr unsigned default_depth = 3;
+
+  explicit merkle_digest(unsigned depth = default_depth) : levels(depth + 1) {
+    for (unsigned l = 0; l <= depth; ++l)
+      levels[l].resize(std::size_t{1} << (fanout_bits * l));
+  }
+
+  auto operator==(const merkle_digest &) const noexcept -> bool = default;
+
+  auto depth() const noexcept -> unsigned {
+    return static_cast<unsigned>(levels.size() - 1);
+  }
+
+  /// splitmix64 finalizer, spreads weak std::hash values over all bits.
+  static auto mix(std::uint64_t h) noexcept -> std::uint64_t {
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111eb;
+    return h ^ (h >> 31);
+  }
+
+  /// Bucket an entry whose key hashes to key_hash falls in.
+  static auto bucket_of(std::size_t key_hash, unsigned depth) noexcept
+      -> std::size_t {
+    if (depth == 0)
+      return 0;
+    return static_cast<std::size_t>(mix(key_hash) >>
+                                    (64 - fanout_bits * depth));
+  }
+
+  /// Accounts for an entry whose key hashes to key_hash and whose state
+  /// (a clock, say) hashes to state_hash.
+  void add(std::size_t key_hash, std::size_t state_hash) noexcept {
+    update(key_hash, entry_hash(key_hash, state_hash));
+  }
+
+  /// Undoes add(key_hash, state_hash).
+  void remove(std::size_t key_hash, std::size_t state_hash) noexcept {
+    update(key_hash, -entry_hash(key_hash, state_hash));
+  }
+
+  /// Node hashes of level l, level 0 being the root and level depth() the
+  /// buckets.
+  auto level(unsigned l) const noexcept -> std::span<const std::uint64_t> {
+    return levels[l];
+  }
+
+  /// One round of the comparison: the subset of nodes of level l whose
+  /// hashes differ from theirs, given in the same order as nodes.
+  auto compare(unsigned l, std::span<const std::size_t> nodes,
+               std::span<const std::uint64_t> theirs) const
+      -> std::vector<std::size_t> {
+    std::vector<std::size_t> differing;
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+      if (levels[l][nodes[i]] != theirs[i])
+        differing.push_back(nodes[i]);
+    return differing;
+  }
+
+  /// Hashes of the given nodes of level l, what the other side of a round
+  /// sends.
+  auto hashes(unsigned l, std::span<const std::size_t> nodes) const
+      -> std::vector<std::uint64_t> {
+    std::vector<std::uint64_t> result;
+    result.reserve(nodes.size());
+    for (auto node : nodes)
+      result.push_back(levels[l][node]);
+    return result;
+  }
+
+  /// Children on level l + 1 of the given nodes of level l.
+  static auto children(std::span<const std::size_t> nodes)
+      -> std::vector<std::size_t> {
+    std::vector<std::size_t> result;
+    result.reserve(nodes.size() * fanout);
+    for (auto node : nodes)
+      for (std::size_t c = 0; c < fanout; ++c)
+        result.push_back(node * fanout + c);
+    return result;
+  }
+
+  /// Buckets on which both digests disagree, in increasing order. Both must
+  /// have the same depth.
+  auto differing(const merkle_digest &other) const -> std::vector<std::size_t> {
+    std::vector<std::size_t> nodes{0};
+    for (unsigned l = 0;; ++l) {
+      nodes = compare(l, nodes, other.hashes(l, nodes));
+      if (l == depth() || nodes.empty())
+        return nodes;
+      nodes = children(nodes);
+    }
+  }
+
+private:
+  static auto entry_hash(std::uint64_t key_hash,
+                         std::uint64_t state_hash) noexcept -> std::uint64_t {
+    return mix(key_hash ^ mix(state_hash));
+  }
+
+  void update(std::size_t key_hash, std::uint64_t delta) noexcept {
+    auto node = bucket_of(key_hash, depth());
+    for (auto l = depth() + 1; l-- > 0; node /= fanout)
+      levels[l][node] += delta;
+  }
+
+  std::vector<std::vector<std::uint64_t>> levels;
+};
+
+/// Part of a replica's state covering only the buckets a digest comparison
+/// found different. Merging it touches entries in those buckets only, the
+/// others being identical on both sides already.
+template <typename _State> struct digest_delta {
+  _State state;
+  unsigned depth = merkle_digest::default_depth;
+  /// Sorted bucket numbers.
+  std::vector<std::size_t> buckets;
+
+  auto covers(std::size_t key_hash) const noexcept -> bool {
+    return std::binary_search(buckets.begin(), buckets.end(),
+                              merkle_digest::bucket_of(key_hash, depth));
+  }
+};
+
+} // namespace crdt.
+
+#endif // MERKLE_DIGEST_H
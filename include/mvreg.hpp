@@ -3,10 +3,16 @@
 
 #include <algorithm>
 #include <compare>
+#include <concepts>
+#include <cstddef>
+#include <ranges>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <context.hpp>
 #include <crdt_traits.hpp>
+#include <small_vector.hpp>
 #include <version_vector.hpp>
 
 namespace crdt {
@@ -29,14 +35,34 @@ template <actor_type A, value_type T> struct mvreg {
   };
 
   using Op = value;
-  std::vector<value> vals;
+  using storage_type = small_vector<value, 1>;
+
+  /// Concurrent values, an antichain: no value's clock dominates another's.
+  /// A register holding a single value keeps it inline.
+  storage_type vals;
+
+  mvreg() = default;
+  mvreg(const mvreg<A, T> &) = default;
+  mvreg(mvreg<A, T> &&) = default;
+  mvreg<A, T> &operator=(const mvreg<A, T> &) = default;
+  mvreg<A, T> &operator=(mvreg<A, T> &&) = default;
+
+  /// Register holding the given values, which must form an antichain.
+  template <std::ranges::input_range _Values>
+    requires std::convertible_to<std::ranges::range_reference_t<_Values>,
+                                 const value &>
+  explicit mvreg(const _Values &values) {
+    for (const auto &val : values)
+      vals.push_back(val);
+    rejoin();
+  }
 
   auto operator==(const mvreg<A, T> &other) const noexcept -> bool {
-    const auto cmp_values = [](const std::vector<value> &v1,
-                               const std::vector<value> &v2) -> bool {
+    const auto cmp_values = [](const storage_type &v1,
+                               const storage_type &v2) -> bool {
       for (const auto &d : v1) {
         if (std::none_of(v2.begin(), v2.end(),
-                         [=](const value &v) { return v == d; }))
+                         [&](const value &v) { return v == d; }))
           return false;
       }
       return true;
@@ -45,10 +71,16 @@ template <actor_type A, value_type T> struct mvreg {
   }
 
   void reset_remove(const version_vector<A> &clock) noexcept {
-    std::erase_if(vals, [&clock](auto val) {
-      val.vclock.reset_remove(clock);
-      return val.vclock.empty();
-    });
+    auto kept = std::remove_if(vals.begin(), vals.end(),
+                               [&clock](const auto &val) {
+                                 return clock.dominates(val.vclock);
+                               });
+    if (kept == vals.end())
+      return;
+
+    vals.erase(kept, vals.end());
+    vals.compact();
+    rejoin();
   }
 
   auto validate_merge(const mvreg<A, T> &other) const noexcept
@@ -56,19 +88,18 @@ template <actor_type A, value_type T> struct mvreg {
     return std::nullopt;
   }
 
-  void merge(mvreg<A, T> other) noexcept {
-    std::erase_if(vals, [other](const auto &val) {
-      return std::any_of(
-          other.vals.begin(), other.vals.end(),
-          [clock = val.vclock](const auto &val) { return val.vclock >= clock; });
-    });
-    std::erase_if(other.vals, [vals = vals](const auto &val) {
-      return std::any_of(vals.begin(), vals.end(),
-                         [clock = val.vclock](const auto &val) {
-                           return val.vclock >= clock;
-                         });
-    });
-    vals.insert(vals.end(), other.vals.begin(), other.vals.end());
+  /// vals is kept an antichain: no value's clock dominates another's. Each
+  /// pair of values is compared once, and other is read in place.
+  void merge(const mvreg<A, T> &other) noexcept {
+    if (merge_values(other.vals))
+      rejoin();
+  }
+
+  /// Same as merge(const mvreg<A, T> &), moving the surviving values out
+  /// of other.
+  void merge(mvreg<A, T> &&other) noexcept {
+    if (merge_values(std::move(other.vals)))
+      rejoin();
   }
 
   auto validate_op(const Op &_) const noexcept
@@ -77,21 +108,39 @@ template <actor_type A, value_type T> struct mvreg {
   }
 
   void apply(const Op &op) noexcept {
-    if (std::none_of(vals.begin(), vals.end(),
-                     [clock = op.vclock](const auto &val) {
-                       return val.vclock > clock;
-                     }))
-      vals.push_back(op);
+    // in an antichain no value can be above op while another is below it,
+    // so one pass either finds op covered or drops what op supersedes, and
+    // the values dropped are all below op in the joined clock as well.
+    auto covered = false;
+    vals.erase(std::remove_if(vals.begin(), vals.end(),
+                              [&](const auto &val) {
+                                auto order = val.vclock <=> op.vclock;
+                                covered |= order >= 0;
+                                return order < 0;
+                              }),
+               vals.end());
+    if (covered)
+      return;
+    auto had_joined = vals.size() > 1;
+    vals.push_back(op);
+    vals.compact();
+    if (had_joined)
+      joined.merge(op.vclock);
+    else
+      rejoin();
   }
 
   auto write(const add_context<A> &ctx, T val) const noexcept -> Op {
     return value{ctx.vector, val};
   }
 
-  auto write(const A &actor, const T &val) const noexcept -> mvreg<A, T> {
-    mvreg<A, T> reg;
-    reg.apply(reg.write(read().derive_add_context(actor), val));
-    return mvreg<A, T>{};
+  /// Writes val locally and returns the delta holding just the new value.
+  auto write(const A &actor, const T &val) noexcept -> mvreg<A, T> {
+    auto op = write(read_ctx().derive_add_context(actor), val);
+    mvreg<A, T> delta;
+    delta.apply(op);
+    apply(op);
+    return delta;
   }
 
   auto read() const noexcept -> read_context<std::vector<T>, A> {
@@ -102,18 +151,93 @@ template <actor_type A, value_type T> struct mvreg {
   }
 
   auto read_ctx() const noexcept -> read_context<std::vector<T>, A> {
-    auto clock = this->clock();
+    const auto &clock = this->clock();
     return read_context<std::vector<T>, A>(clock, clock, std::vector<T>{});
   }
 
-  auto clock() const noexcept -> version_vector<A> {
-    version_vector<A> resutl{};
+  /// Join of every value's clock: the clock of the only value when there is
+  /// one, and an empty clock when there is none.
+  auto clock() const noexcept -> const version_vector<A> & {
+    return vals.size() == 1 ? vals.front().vclock : joined;
+  }
+
+private:
+  /// Returns false when theirs already equals vals and nothing changed.
+  template <typename _Vals>
+  auto merge_values(_Vals &&theirs) noexcept -> bool {
+    if (std::ranges::equal(vals, theirs))
+      return false;
+
+    // a value of ours below one of theirs cannot be above any other of
+    // theirs, so the scan over theirs stops there; theirs already found
+    // covered cannot dominate anything of ours either.
+    std::vector<bool> covered(theirs.size());
+    vals.erase(std::remove_if(vals.begin(), vals.end(),
+                              [&](const auto &ours) {
+                                for (std::size_t i = 0; i < theirs.size();
+                                     ++i) {
+                                  if (covered[i])
+                                    continue;
+                                  auto order =
+                                      ours.vclock <=> theirs[i].vclock;
+                                  if (order < 0)
+                                    return true;
+                                  if (order >= 0)
+                                    covered[i] = true;
+                                }
+                                return false;
+                              }),
+               vals.end());
+
+    for (std::size_t i = 0; i < theirs.size(); ++i) {
+      if (covered[i])
+        continue;
+      if constexpr (std::is_lvalue_reference_v<_Vals>)
+        vals.push_back(theirs[i]);
+      else
+        vals.push_back(std::move(theirs[i]));
+    }
+    vals.compact();
+    return true;
+  }
+
+  /// Recomputes joined from vals, leaving it empty unless there are several
+  /// values to join.
+  void rejoin() noexcept {
+    joined = version_vector<A>{};
+    if (vals.size() < 2)
+      return;
     for (const auto &val : vals)
-      resutl.merge(val.vclock);
-    return resutl;
+      joined.merge(val.vclock);
   }
+
+  /// Join of every value's clock, only kept while there are several values;
+  /// a register holding one value reads its clock in place.
+  version_vector<A> joined;
 };
 
 } // namespace crdt.
 
+namespace std {
+
+template <crdt::actor_type A, crdt::value_type T>
+  requires crdt::hashable<std::hash<T>, T>
+struct hash<crdt::mvreg<A, T>> {
+  size_t operator()(const crdt::mvreg<A, T> &reg) const {
+    std::hash<crdt::version_vector<A>> clock_hash;
+    std::hash<T> val_hash;
+    // summed like version_vector's entries, so replicas holding the same
+    // values in another order agree.
+    size_t sum = 0;
+    for (const auto &v : reg.vals) {
+      auto h = clock_hash(v.vclock);
+      h ^= val_hash(v.val) + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+      sum += h;
+    }
+    return sum;
+  }
+};
+
+} // namespace std
+
 #endif // MV_REG_H
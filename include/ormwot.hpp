@@ -3,20 +3,27 @@
 
 #include <algorithm>
 #include <compare>
+#include <concepts>
 #include <cstddef>
+#include <functional>
 #include <numeric>
 #include <optional>
-#include <set>
+#include <ranges>
 #include <system_error>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include <context.hpp>
 #include <crdt_traits.hpp>
+#include <deferred_removals.hpp>
 #include <dot.hpp>
+#include <dot_cloud.hpp>
+#include <merkle_digest.hpp>
+#include <parallel_merge.hpp>
 #include <version_vector.hpp>
 
 namespace crdt {
@@ -46,17 +53,26 @@ template <
 struct ormwot {
   using actor_t = typename _Value::actor_t;
   using vector_clock = version_vector<actor_t>;
+  using cloud_type = dot_cloud<actor_t>;
   using deferred_set = _Key_set;
+  using deferred_store =
+      deferred_removals<actor_t, _Key, _Key_set, _Deferred_map>;
   using entry_type = details::map::Entry<actor_t, _Value>;
   using ormwot_type = ormwot<_Key, _Value, _Key_set, _Entries_map, _Deferred_map>;
+  /// Whether values can be hashed into a digest, see keep_digest.
+  static constexpr bool digestible = hashable<std::hash<_Value>, _Value>;
 
   vector_clock clock;
+  /// Dots applied ahead of clock, see dot_cloud.
+  cloud_type cloud;
   _Entries_map entries;
-  _Deferred_map deferred;
+  deferred_store deferred;
 
   ormwot() = default;
   ormwot(const ormwot_type &) = default;
   ormwot(ormwot_type &&) = default;
+  auto operator=(const ormwot_type &) -> ormwot_type & = default;
+  auto operator=(ormwot_type &&) -> ormwot_type & = default;
 
   struct Add {
     dot<actor_t> d;
@@ -93,88 +109,81 @@ struct ormwot {
 
   using Op = std::variant<Add, Rm>;
 
-  void apply_keyset_rm(deferred_set keyset, vector_clock vclock) noexcept {
-    for (const auto &key : keyset) {
-      if (auto entry = entries.find(key); entry != entries.end()) {
-        entry->second.clock.reset_remove(vclock);
+  void apply_keyset_rm(const deferred_set &keyset,
+                       const vector_clock &vclock) noexcept {
+    for (const auto &key : keyset)
+      apply_key_rm(key, vclock);
 
-        if (entry->second.clock.empty()) {
-          entries.erase(entry);
-        } else {
-          entry->second.val.reset_remove(vclock);
-        }
-      }
-    }
+    deferred.defer(clock, vclock, keyset);
+  }
 
-    if (auto cmp = this->clock <=> vclock;
-        cmp == std::partial_ordering::less ||
-        cmp == std::partial_ordering::unordered) {
-      if (auto existing_deferred = deferred.find(vclock);
-          existing_deferred != deferred.end()) {
-        existing_deferred->second.insert(keyset.begin(), keyset.end());
+  void apply_key_rm(const _Key &key, const vector_clock &vclock) noexcept {
+    if (auto entry = entries.find(key); entry != entries.end()) {
+      untrack(key, entry->second);
+      entry->second.clock.reset_remove(vclock);
+
+      if (entry->second.clock.empty()) {
+        entries.erase(entry);
       } else {
-        deferred[vclock] = keyset;
+        entry->second.val.reset_remove(vclock);
+        track(key, entry->second);
       }
     }
   }
 
+  /// Re-applies every pending removal, needed once entries arrive through a
+  /// merge rather than one add at a time.
   void apply_deferrd() noexcept {
-    for (auto [vclock, entrs] : deferred) {
-      apply_keyset_rm(entrs, vclock);
-    }
+    deferred.for_each([this](const auto &vclock, const auto &keyset) {
+      for (const auto &key : keyset)
+        apply_key_rm(key, vclock);
+    });
+    deferred.release(clock);
   }
 
   void reset_remove(const version_vector<actor_t> &vclock) noexcept {
     for (auto it = entries.begin(); it != entries.end();) {
+      untrack(it->first, it->second);
       it->second.val.reset_remove(vclock);
       it->second.clock.reset_remove(vclock);
       if (it->second.clock.empty()) {
         it = entries.erase(it);
       } else {
-        ++it;
-      }
-    }
-
-    for (auto it = deferred.begin(); it != deferred.end();) {
-      it->first.reset_remove(vclock);
-      if (it->first.empty()) {
-        it = deferred.erase(it);
-      } else {
+        track(it->first, it->second);
         ++it;
       }
     }
 
     clock.reset_remove(vclock);
+    cloud.reset_remove(vclock);
+    deferred.reset_remove(vclock, clock);
   }
 
   auto validate_op(const Op &op) const noexcept
       -> std::optional<std::error_condition> {
     return std::visit(overloaded{
-                          [this](Add add) {
-                            auto res(this->clock.validate_op(add.d));
-                            return res.value_or(validate_entry_op(add));
+                          [this](const Add &add) {
+                            return validate_entry_op(add);
+                          },
+                          [](const Rm &) -> std::optional<std::error_condition> {
+                            return std::nullopt;
                           },
-                          [](Rm) { return std::nullopt; },
                       },
                       op);
   }
 
-  auto validate_entry_op(const Add add) const noexcept
+  auto validate_entry_op(const Add &add) const noexcept
       -> std::optional<std::error_condition> {
-    entry_type entry;
-    if (auto it = entries.find(add.key); it != entries.end()) {
-      std::tie(entry.clock, entry.val) = it;
-    }
-
-    return entry.clock.validate_op(add.d).value_or(
-        entry.val.validate_op(add.op));
+    if (auto it = entries.find(add.key); it != entries.end())
+      return it->second.val.validate_op(add.op);
+    return _Value().validate_op(add.op);
   }
 
   void apply(const Op &op) noexcept {
     std::visit(
         overloaded{
             [this](const Add &add) {
-              if (clock.get(add.d.actor) >= add.d.counter) {
+              if (cloud.covers(clock, add.d)) {
                 return;
               }
 
@@ -184,68 +193,171 @@ struct ormwot {
                     entries.insert({add.key, entry_type{}});
               }
 
+              untrack(add.key, it->second);
               it->second.clock.apply(dot(add.d.actor, add.d.counter));
               it->second.val.apply(add.op);
+              track(add.key, it->second);
+              deferred.for_each(add.key, [&](const auto &rm_clock) {
+                apply_key_rm(add.key, rm_clock);
+              });
 
-              clock.apply(dot(add.d.actor, add.d.counter));
-              apply_deferrd();
+              cloud.witness(clock, add.d);
+              deferred.release(clock);
             },
             [this](const Rm &rm) { apply_keyset_rm(rm.keyset, rm.clock); },
         },
         op);
   }
 
-  void merge(const ormwot_type &other) noexcept {
-    for (auto it = entries.begin(); it != entries.end();) {
-      if (!other.entries.contains(it->first)) {
-        if (other.clock >= it->second.clock) {
-          it = entries.erase(it);
-        } else {
-          it->second.clock.reset_remove(other.clock);
-          auto removed_info(other.clock);
-          removed_info.reset_remove(it->second.clock);
-          it->second.val.reset_remove(removed_info);
-          ++it;
-        }
-      } else {
-        ++it;
-      }
+  auto validate_merge(const ormwot_type &) const noexcept
+      -> std::optional<std::error_condition> {
+    return std::nullopt;
+  }
+
+  void merge(const ormwot_type &other) noexcept { merge_state<false>(other); }
+
+  /// Same as merge(const ormwot_type &), but takes over other's storage
+  /// instead of copying it.
+  void merge(ormwot_type &&other) noexcept {
+    if (entries.empty() && deferred.empty() && clock.empty() &&
+        cloud.empty()) {
+      clock = std::move(other.clock);
+      cloud = std::move(other.cloud);
+      entries = std::move(other.entries);
+      deferred = std::move(other.deferred);
+      retrack();
+      return;
     }
+    merge_state<true>(other);
+  }
 
-    for (auto [key, entry] : other.entries) {
-      if (auto our_entry = entries.find(key); our_entry != entries.end()) {
-        auto common = intersection(entry.clock, our_entry->second.clock);
-        common.merge(entry.clock.clone_without(this->clock));
-        common.merge(our_entry->second.clock.clone_without(other.clock));
-        if (common.empty()) {
-          entries.erase(our_entry);
-        } else {
-          our_entry->second.val.merge(entry.val);
+  /// Builds the digest of the entries once and keeps it up to date from
+  /// then on, as orswot::keep_digest does.
+  void keep_digest(unsigned depth = merkle_digest::default_depth)
+    requires digestible
+  {
+    tracked = build_digest(depth);
+  }
 
-          auto removed_info(entry.clock);
-          removed_info.merge(our_entry->second.clock);
-          removed_info.reset_remove(common);
-          our_entry->second.val.reset_remove(removed_info);
-          our_entry->second.clock = common;
-        }
-      } else {
-        if (this->clock >= entry.clock) {
+  /// Digest of the entries bucketed by the hash of their key, see
+  /// merkle_digest.
+  auto digest(unsigned depth = merkle_digest::default_depth) const
+      -> merkle_digest
+    requires digestible
+  {
+    if (tracked && tracked->depth() == depth)
+      return *tracked;
+    return build_digest(depth);
+  }
+
+  /// Entries in the buckets where theirs differs from our digest, with the
+  /// whole causal context and every deferred removal.
+  auto extract(const merkle_digest &theirs) const -> digest_delta<ormwot_type>
+    requires digestible
+  {
+    digest_delta<ormwot_type> delta{{}, theirs.depth(), {}};
+    if (tracked && tracked->depth() == theirs.depth())
+      delta.buckets = tracked->differing(theirs);
+    else
+      delta.buckets = build_digest(theirs.depth()).differing(theirs);
+    delta.state.clock = clock;
+    delta.state.cloud = cloud;
+    delta.state.deferred = deferred;
+    for (const auto &[key, entry] : entries)
+      if (delta.covers(std::hash<_Key>{}(key)))
+        delta.state.entries.emplace(key, entry);
+    return delta;
+  }
+
+  /// Merges the result of extract(), leaving the buckets it does not cover
+  /// alone: their keys, clocks and values already agree with the other
+  /// replica's.
+  void merge(const digest_delta<ormwot_type> &delta) noexcept
+    requires digestible
+  {
+    merge_state<false>(delta.state, [&](const _Key &key) {
+      return delta.covers(std::hash<_Key>{}(key));
+    });
+  }
+
+  /// Same as merge(const ormwot_type &), with the walk over both entry maps
+  /// split into par.shards runs merged concurrently.
+  void merge(const ormwot_type &other, parallel_merge par) {
+    // writes to a persistent map copy shared paths, which shards cannot do
+    // concurrently.
+    if constexpr (persistent_type<_Entries_map>) {
+      merge(other);
+      return;
+    }
+
+    auto shards = std::max<std::size_t>(par.shards, 1);
+    auto ours = details::split(entries.begin(), entries.end(), entries.size(),
+                               shards);
+    auto theirs = details::split(other.entries.begin(), other.entries.end(),
+                                 other.entries.size(), shards);
+
+    // entries are updated in place by the shard owning them, only erasures
+    // and insertions change the map and wait for every shard to finish.
+    std::vector<std::vector<_Key>> erased(shards);
+    std::vector<std::vector<std::pair<_Key, entry_type>>> adopted(shards);
+    details::run_shards(shards, [&](std::size_t s) {
+      for (auto it = ours[s]; it != ours[s + 1]; ++it) {
+        auto &our_entry = it->second;
+        if (auto entry = other.entries.find(it->first);
+            entry == other.entries.end()) {
+          if (other.cloud.dominates(other.clock, our_entry.clock)) {
+            erased[s].push_back(it->first);
+          } else {
+            our_entry.clock = other.cloud.clone_without(
+                std::move(our_entry.clock), other.clock);
+            auto removed_info(other.clock);
+            removed_info.reset_remove(our_entry.clock);
+            our_entry.val.reset_remove(removed_info);
+          }
         } else {
-          entry.clock.reset_remove(clock);
-          auto removed_info(clock);
-          removed_info.reset_remove(entry.clock);
-          entry.val.reset_remove(removed_info);
-          entries[key] = entry;
+          auto common = intersection(entry->second.clock, our_entry.clock);
+          common.merge(cloud.clone_without(entry->second.clock, clock));
+          common.merge(other.cloud.clone_without(our_entry.clock, other.clock));
+          if (common.empty()) {
+            erased[s].push_back(it->first);
+          } else {
+            our_entry.val.merge(entry->second.val);
+
+            auto removed_info(entry->second.clock);
+            removed_info.merge(our_entry.clock);
+            removed_info.reset_remove(common);
+            our_entry.val.reset_remove(removed_info);
+            our_entry.clock = std::move(common);
+          }
         }
       }
-    }
 
-    for (auto [rm_clock, keys] : other.deferred) {
-      apply_keyset_rm(keys, rm_clock);
+      for (auto it = theirs[s]; it != theirs[s + 1]; ++it) {
+        if (entries.contains(it->first) ||
+            cloud.dominates(clock, it->second.clock))
+          continue;
+        auto incoming(it->second);
+        adopt(incoming);
+        adopted[s].emplace_back(it->first, std::move(incoming));
+      }
+    });
+
+    for (const auto &keys : erased)
+      for (const auto &key : keys)
+        entries.erase(entries.find(key));
+    if constexpr (requires(std::size_t n) { entries.reserve(n); }) {
+      std::size_t count = entries.size();
+      for (const auto &keys : adopted)
+        count += keys.size();
+      entries.reserve(count);
     }
+    for (auto &keys : adopted)
+      for (auto &[key, entry] : keys)
+        entries.emplace(std::move(key), std::move(entry));
 
-    clock.merge(other.clock);
-    apply_deferrd();
+    merge_context<false>(other);
+    // shards cannot share the digest, so it is rebuilt once they are done.
+    retrack();
   }
 
   auto empty() const noexcept -> read_context<bool, actor_t> {
@@ -271,19 +383,51 @@ struct ormwot {
     return read_context(clock, clock, entry);
   }
 
+  /// Op applying f(ctx, value) to the value of key, f reads the current
+  /// value in place.
   auto update(const add_context<actor_t> &ctx, _Key key, auto f) const noexcept
       -> Op {
-    _Value val;
     if (auto it = entries.find(key); it != entries.end())
-      val = it->second.val;
-    return Add{dot(ctx.dot.actor, ctx.dot.counter), key, f(ctx, val)};
+      return Add{dot(ctx.dot.actor, ctx.dot.counter), key,
+                 f(ctx, it->second.val)};
+    const _Value empty;
+    return Add{dot(ctx.dot.actor, ctx.dot.counter), key, f(ctx, empty)};
   }
 
-  auto update(actor_t actor, _Key key, auto f) noexcept
-      -> ormwot_type {
+  /// Applies the update locally and returns the delta holding just its dot
+  /// and the value's op.
+  auto update(actor_t actor, _Key key, auto f) noexcept -> ormwot_type {
+    auto op = update(read_ctx().derive_add_context(actor), std::move(key), f);
     ormwot_type delta;
-    delta.apply(update(read_ctx().derive_add_context(actor), key, f));
-    merge(delta);
+    delta.apply(op);
+    apply(op);
+    return delta;
+  }
+
+  /// Delta mutator for nested values: f changes the value of key in place
+  /// and returns the value's own delta, as orswot::add, gcounter::inc or
+  /// mutate itself do. The returned delta holds f's delta under one new dot,
+  /// so a change deep inside nested maps ships one entry per level instead
+  /// of whole values.
+  template <std::invocable<_Value &> F>
+  auto mutate(const actor_t &actor, const _Key &key, F f) -> ormwot_type {
+    auto d = clock.inc(actor);
+    auto &entry = entries[key];
+    untrack(key, entry);
+    auto nested = f(entry.val);
+    entry.clock.apply(d);
+    track(key, entry);
+    deferred.for_each(key, [&](const auto &rm_clock) {
+      apply_key_rm(key, rm_clock);
+    });
+    cloud.witness(clock, d);
+    deferred.release(clock);
+
+    ormwot_type delta;
+    auto &delta_entry = delta.entries[key];
+    delta_entry.clock.apply(d);
+    delta_entry.val = std::move(nested);
+    delta.cloud.witness(delta.clock, d);
     return delta;
   }
 
@@ -293,10 +437,17 @@ struct ormwot {
     return Rm{clock, keyset};
   }
 
+  /// Removes key locally and returns the delta removing the dots it was
+  /// observed with, empty when key is absent.
   auto rm(actor_t _, _Key key) noexcept -> ormwot_type {
     ormwot_type delta;
-    delta.apply(rm(read_ctx().derive_remove_context(), key));
-    merge(delta);
+    if (auto it = entries.find(key); it != entries.end()) {
+      deferred_set keyset;
+      keyset.insert(key);
+      Op op = Rm{it->second.clock, std::move(keyset)};
+      delta.apply(op);
+      apply(op);
+    }
     return delta;
   }
 
@@ -304,19 +455,317 @@ struct ormwot {
     return read_context<void *, actor_t>(clock, clock, nullptr);
   }
 
-  auto keys() const noexcept -> std::set<read_context<_Key, actor_t>> {
-    std::set<read_context<_Key, actor_t>> keys;
-    for (auto [key, val] : entries)
-      keys.emplace(read_context(clock, val.clock, key));
-    return keys;
+  /// Keys read in place from entries, see read_view.
+  auto keys() const noexcept {
+    return read_view(clock, std::views::keys(entries));
+  }
+
+  /// Values read in place from entries, see read_view.
+  auto values() const noexcept {
+    auto val = [](const auto &entry) -> const _Value & {
+      return entry.second.val;
+    };
+    return read_view(clock, entries | std::views::transform(val));
+  }
+
+  /// Key and value pairs read in place from entries, see read_view.
+  auto items() const noexcept {
+    return read_view(clock, entries | std::views::transform(item_of));
+  }
+
+  /// Key and value pairs with first <= key < last, in key order. Only the
+  /// entries in the range are visited.
+  auto range(const _Key &first, const _Key &last) const noexcept
+    requires ordered_type<_Entries_map>
+  {
+    auto from = entries.lower_bound(first);
+    auto to = entries.key_comp()(first, last) ? entries.lower_bound(last)
+                                              : from;
+    return read_view(clock, std::ranges::subrange(from, to) |
+                                std::views::transform(item_of));
+  }
+
+  /// Key and value pairs whose key starts with head, in key order, e.g.
+  /// every key of one tenant when keys are prefixed with it.
+  auto prefix(const _Key &head) const
+    requires ordered_type<_Entries_map> &&
+             std::ranges::forward_range<const _Key &>
+  {
+    auto starts_with = [head](const auto &entry) {
+      return std::ranges::mismatch(head, entry.first).in1 ==
+             std::ranges::end(head);
+    };
+    return read_view(
+        clock, std::ranges::subrange(entries.lower_bound(head), entries.end()) |
+                   std::views::take_while(starts_with) |
+                   std::views::transform(item_of));
   }
 
-  auto values() const noexcept -> std::vector<read_context<_Key, actor_t>> {
-    std::vector<read_context<_Key, actor_t>> values;
-    for (auto [key, val] : entries)
-      values.emplace_back(read_context(clock, val.clock, key));
-    return values;
+  /// Key and clock pairs read in place from entries, see read_view.
+  auto clocks() const noexcept {
+    auto key_clock = [](const auto &entry) {
+      return std::pair<const _Key &, const vector_clock &>(entry.first,
+                                                          entry.second.clock);
+    };
+    return read_view(clock, entries | std::views::transform(key_clock));
   }
+
+private:
+  static constexpr auto item_of = [](const auto &entry) {
+    return std::pair<const _Key &, const _Value &>(entry.first,
+                                                  entry.second.val);
+  };
+
+  template <bool _Steal, typename _Other>
+  void merge_state(_Other &other) noexcept {
+    merge_state<_Steal>(other, [](const _Key &) { return true; });
+  }
+
+  /// Merge leaving our entries outside within alone, other holding none
+  /// outside of it either.
+  template <bool _Steal, typename _Other, typename _Within>
+  void merge_state(_Other &other, _Within within) noexcept {
+    if constexpr (ordered_type<_Entries_map>) {
+      merge_join<_Steal>(other, within);
+      return;
+    }
+
+    // entries are read through a const view and written only where they
+    // change, so persistent maps copy nothing for unchanged keys.
+    const auto &ours = entries;
+    for (auto it = ours.begin(); it != ours.end();) {
+      const auto &[key, our_entry] = *it;
+      if (!within(key) || other.entries.contains(key)) {
+        ++it;
+      } else if (other.cloud.dominates(other.clock, our_entry.clock)) {
+        untrack(key, our_entry);
+        it = entries.erase(entries.find(key));
+      } else {
+        auto rest = other.cloud.clone_without(our_entry.clock, other.clock);
+        auto removed_info(other.clock);
+        removed_info.reset_remove(rest);
+        if (rest == our_entry.clock && removed_info.empty()) {
+          ++it;
+          continue;
+        }
+
+        untrack(key, our_entry);
+        auto changed = entries.find(key);
+        changed->second.clock = std::move(rest);
+        changed->second.val.reset_remove(removed_info);
+        track(key, changed->second);
+        it = ++changed;
+      }
+    }
+
+    for (auto it = other.entries.begin(); it != other.entries.end();) {
+      const auto &[key, entry] = *it;
+      if (auto our_entry = ours.find(key); our_entry != ours.end()) {
+        if (entry.clock == our_entry->second.clock &&
+            entry.val == our_entry->second.val) {
+          ++it;
+          continue;
+        }
+
+        auto common = intersection(entry.clock, our_entry->second.clock);
+        common.merge(cloud.clone_without(entry.clock, this->clock));
+        common.merge(
+            other.cloud.clone_without(our_entry->second.clock, other.clock));
+        untrack(key, our_entry->second);
+        if (common.empty()) {
+          entries.erase(entries.find(key));
+        } else {
+          auto &changed = entries.find(key)->second;
+          if constexpr (_Steal)
+            changed.val.merge(std::move(it->second.val));
+          else
+            changed.val.merge(entry.val);
+
+          auto removed_info(entry.clock);
+          removed_info.merge(changed.clock);
+          removed_info.reset_remove(common);
+          changed.val.reset_remove(removed_info);
+          changed.clock = std::move(common);
+          track(key, changed);
+        }
+      } else if (!cloud.dominates(clock, entry.clock)) {
+        if constexpr (_Steal) {
+          if constexpr (requires { other.entries.extract(it); }) {
+            auto node = other.entries.extract(it++);
+            adopt(node.mapped());
+            track(node.key(), node.mapped());
+            entries.insert(std::move(node));
+            continue;
+          } else {
+            adopt(it->second);
+            track(key, it->second);
+            entries.emplace(key, std::move(it->second));
+          }
+        } else {
+          auto incoming(entry);
+          adopt(incoming);
+          track(key, incoming);
+          entries.emplace(key, std::move(incoming));
+        }
+      }
+      ++it;
+    }
+
+    merge_context<_Steal>(other);
+  }
+
+  /// merge_state for ordered entries: both maps are walked once in key
+  /// order, pairing equal keys as they come instead of looking each up in
+  /// the other map. Entries only they have are inserted after the walk, as
+  /// inserting may invalidate our iterators.
+  template <bool _Steal, typename _Other, typename _Within>
+  void merge_join(_Other &other, _Within within) noexcept {
+    auto less = entries.key_comp();
+    std::vector<std::pair<_Key, entry_type>> adopted;
+    auto ours = entries.begin();
+    auto theirs = other.entries.begin();
+    while (ours != entries.end() || theirs != other.entries.end()) {
+      if (theirs == other.entries.end() ||
+          (ours != entries.end() && less(ours->first, theirs->first))) {
+        auto &our_entry = ours->second;
+        if (!within(ours->first)) {
+          ++ours;
+        } else if (other.cloud.dominates(other.clock, our_entry.clock)) {
+          untrack(ours->first, our_entry);
+          ours = entries.erase(ours);
+        } else {
+          untrack(ours->first, our_entry);
+          our_entry.clock = other.cloud.clone_without(
+              std::move(our_entry.clock), other.clock);
+          auto removed_info(other.clock);
+          removed_info.reset_remove(our_entry.clock);
+          our_entry.val.reset_remove(removed_info);
+          track(ours->first, our_entry);
+          ++ours;
+        }
+        continue;
+      }
+
+      auto &entry = theirs->second;
+      if (ours == entries.end() || less(theirs->first, ours->first)) {
+        if (!cloud.dominates(clock, entry.clock)) {
+          if constexpr (_Steal)
+            adopted.emplace_back(theirs->first, std::move(entry));
+          else
+            adopted.emplace_back(theirs->first, entry);
+          adopt(adopted.back().second);
+        }
+        ++theirs;
+        continue;
+      }
+
+      auto &our_entry = ours->second;
+      if (entry.clock == our_entry.clock && entry.val == our_entry.val) {
+        ++ours;
+        ++theirs;
+        continue;
+      }
+
+      auto common = intersection(entry.clock, our_entry.clock);
+      common.merge(cloud.clone_without(entry.clock, clock));
+      common.merge(other.cloud.clone_without(our_entry.clock, other.clock));
+      untrack(ours->first, our_entry);
+      if (common.empty()) {
+        ours = entries.erase(ours);
+      } else {
+        if constexpr (_Steal)
+          our_entry.val.merge(std::move(entry.val));
+        else
+          our_entry.val.merge(entry.val);
+
+        auto removed_info(entry.clock);
+        removed_info.merge(our_entry.clock);
+        removed_info.reset_remove(common);
+        our_entry.val.reset_remove(removed_info);
+        our_entry.clock = std::move(common);
+        track(ours->first, our_entry);
+        ++ours;
+      }
+      ++theirs;
+    }
+
+    for (auto &[key, entry] : adopted) {
+      track(key, entry);
+      entries.emplace(std::move(key), std::move(entry));
+    }
+
+    merge_context<_Steal>(other);
+  }
+
+  template <bool _Steal, typename _Other>
+  void merge_context(_Other &other) noexcept {
+    other.deferred.for_each([this](const auto &rm_clock, const auto &keys) {
+      apply_keyset_rm(keys, rm_clock);
+    });
+
+    clock.merge(other.clock);
+    if constexpr (_Steal)
+      cloud.merge(std::move(other.cloud));
+    else
+      cloud.merge(other.cloud);
+    cloud.compact(clock);
+    apply_deferrd();
+  }
+
+  /// Strips what this replica has already seen from an entry it lacks.
+  void adopt(entry_type &entry) noexcept {
+    entry.clock = cloud.clone_without(std::move(entry.clock), clock);
+    auto removed_info(clock);
+    removed_info.reset_remove(entry.clock);
+    entry.val.reset_remove(removed_info);
+  }
+
+  /// Hash of an entry's clock and value: replicas may agree on a clock
+  /// and still hold different values, e.g. once a concurrent removal took
+  /// the dot of a write the value still holds out of the clock. The value's
+  /// hash is mixed first so that it cannot cancel the clock's out.
+  static auto entry_hash(const entry_type &entry) noexcept -> size_t
+    requires digestible
+  {
+    return merkle_digest::mix(
+        std::hash<vector_clock>{}(entry.clock) ^
+        merkle_digest::mix(std::hash<_Value>{}(entry.val)));
+  }
+
+  auto build_digest(unsigned depth) const -> merkle_digest
+    requires digestible
+  {
+    merkle_digest tree(depth);
+    for (const auto &[key, entry] : entries)
+      tree.add(std::hash<_Key>{}(key), entry_hash(entry));
+    return tree;
+  }
+
+  /// Accounts for key's entry in the kept digest once its clock or value
+  /// was added or changed; entries with empty clocks are never kept and
+  /// never tracked.
+  void track(const _Key &key, const entry_type &entry) noexcept {
+    if constexpr (digestible)
+      if (tracked && !entry.clock.empty())
+        tracked->add(std::hash<_Key>{}(key), entry_hash(entry));
+  }
+
+  /// Undoes track(key, entry) before its clock or value changes or it is
+  /// erased.
+  void untrack(const _Key &key, const entry_type &entry) noexcept {
+    if constexpr (digestible)
+      if (tracked && !entry.clock.empty())
+        tracked->remove(std::hash<_Key>{}(key), entry_hash(entry));
+  }
+
+  void retrack() {
+    if constexpr (digestible)
+      if (tracked)
+        tracked = build_digest(tracked->depth());
+  }
+
+  /// Digest kept up to date with entries, see keep_digest.
+  std::optional<merkle_digest> tracked;
 };
 
 } // namespace crdt
@@ -3,22 +3,34 @@
 
 #include <algorithm>
 #include <compare>
+#include <cstddef>
+#include <functional>
 #include <iterator>
 #include <optional>
+#include <ranges>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include <context.hpp>
 #include <crdt_traits.hpp>
+#include <deferred_removals.hpp>
 #include <dot.hpp>
+#include <dot_cloud.hpp>
+#include <merkle_digest.hpp>
+#include <parallel_merge.hpp>
 #include <version_vector.hpp>
 
 namespace crdt {
 
+/// Members' clocks are whatever version_vector the entries map holds, so
+/// they may use a smaller dots backend than the replica's clock, e.g.
+/// inline_clock in a flat_table.
 template <actor_type _Key, actor_type _Actor,
-          iterable_assiative_type<_Key, version_vector<_Actor>> _Entries_map =
+          clock_map_type<_Key, _Actor> _Entries_map =
               std::unordered_map<_Key, version_vector<_Actor>>,
           set_type<_Key> _Deferred_set_type = std::unordered_set<_Key>,
           iterable_assiative_type<version_vector<_Actor>, _Deferred_set_type>
@@ -26,12 +38,18 @@ template <actor_type _Key, actor_type _Actor,
                   std::unordered_map<version_vector<_Actor>, _Deferred_set_type>>
 struct orswot {
   using vector_clock = version_vector<_Actor>;
+  using member_clock = typename _Entries_map::mapped_type;
+  using cloud_type = dot_cloud<_Actor>;
   using deferred_set = _Deferred_set_type;
+  using deferred_store =
+      deferred_removals<_Actor, _Key, _Deferred_set_type, _Deferred_map>;
   using orswot_type = orswot<_Key, _Actor, _Entries_map, _Deferred_set_type, _Deferred_map>;
 
   vector_clock clock;
+  /// Dots applied ahead of clock, see dot_cloud.
+  cloud_type cloud;
   _Entries_map entries;
-  _Deferred_map deferred;
+  deferred_store deferred;
 
   orswot() = default;
   orswot(const orswot_type &) = default;
@@ -64,140 +82,279 @@ struct orswot {
       -> std::optional<std::error_condition> {
     return std::visit(
         overloaded{
-            [this](Add add) { return this->clock.validate_op(add.d); },
-            [](Rm) { return std::nullopt; },
+            [](const Add &) -> std::optional<std::error_condition> {
+              return std::nullopt;
+            },
+            [](const Rm &) -> std::optional<std::error_condition> {
+              return std::nullopt;
+            },
         },
         op);
   }
 
   void apply(const Op &op) noexcept {
+    apply_op(op);
+    deferred.release(clock);
+  }
+
+  /// Applies ops in one pass, releasing deferred removals once at the end.
+  void apply(std::span<const Op> ops) noexcept {
+    if constexpr (requires(std::size_t n) { entries.reserve(n); }) {
+      std::size_t added = 0;
+      for (const auto &op : ops)
+        if (const auto *add = std::get_if<Add>(&op))
+          added += add->members.size();
+      entries.reserve(entries.size() + added);
+    }
+
+    for (const auto &op : ops)
+      apply_op(op);
+    deferred.release(clock);
+  }
+
+  void apply_op(const Op &op) noexcept {
     std::visit(overloaded{
                    [this](const Add &add) {
-                     if (clock.get(add.d.actor) >= add.d.counter) {
+                     if (cloud.covers(clock, add.d)) {
                        return;
                      }
 
                      for (const auto &member : add.members) {
-                       auto member_vclock = this->entries[member];
-                       member_vclock.apply(add.d);
-                       this->entries[member] = member_vclock;
+                       auto &vclock = entries[member];
+                       untrack(member, vclock);
+                       vclock.apply(add.d);
+                       track(member, vclock);
+                       deferred.for_each(member, [&](const auto &rm_clock) {
+                         remove_member(member,
+                                       clock_cast<member_clock>(rm_clock));
+                       });
                      }
 
-                     clock.apply(add.d);
-                     this->apply_deferred();
-                   },
-                   [this](const Rm &rm) {
-                     apply_rm(
-                         deferred_set(rm.members.begin(), rm.members.end()),
-                         rm.clock);
+                     cloud.witness(clock, add.d);
                    },
+                   [this](const Rm &rm) { apply_rm(rm.members, rm.clock); },
                },
                op);
   }
 
+  /// Re-applies every pending removal, needed once entries arrive through a
+  /// merge rather than one add at a time.
   void apply_deferred() {
-    for (auto [vclock, entrs] : deferred) {
-      apply_rm(entrs, vclock);
-    }
+    deferred.for_each([this](const auto &vclock, const auto &members) {
+      const auto &removed = clock_cast<member_clock>(vclock);
+      for (const auto &member : members)
+        remove_member(member, removed);
+    });
+    deferred.release(clock);
   }
 
-  void apply_rm(deferred_set members, vector_clock vclock) {
-    for (const auto &member : members) {
-      if (const auto &member_clock = entries.find(member);
-          member_clock != entries.end()) {
-        member_clock->second.reset_remove(vclock);
+  template <typename _Members>
+  void apply_rm(const _Members &members, const vector_clock &vclock) {
+    const auto &removed = clock_cast<member_clock>(vclock);
+    for (const auto &member : members)
+      remove_member(member, removed);
 
-        if (member_clock->second.empty())
-          entries.erase(member_clock);
-      }
-    }
+    deferred.defer(clock, vclock, members);
+  }
 
-    if (auto cmp = vclock <=> this->clock;
-        cmp == std::partial_ordering::greater ||
-        cmp == std::partial_ordering::unordered) {
-      if (auto existing_deferred = deferred.find(vclock);
-          existing_deferred != deferred.end()) {
-        existing_deferred->second.insert(members.begin(), members.end());
-      } else {
-        deferred[vclock] = members;
-      }
+  void remove_member(const _Key &member, const member_clock &vclock) {
+    if (auto it = entries.find(member); it != entries.end()) {
+      untrack(member, it->second);
+      it->second.reset_remove(vclock);
+
+      if (it->second.empty())
+        entries.erase(it);
+      else
+        track(member, it->second);
     }
   }
 
   void reset_remove(version_vector<_Actor> vclock) {
     clock.reset_remove(vclock);
+    cloud.reset_remove(vclock);
 
+    const auto &removed = clock_cast<member_clock>(vclock);
     for (auto it = entries.begin(); it != entries.end();) {
-      it->second.reset_remove(vclock);
+      untrack(it->first, it->second);
+      it->second.reset_remove(removed);
       if (it->second.empty()) {
         it = entries.erase(it);
       } else {
+        track(it->first, it->second);
         ++it;
       }
     }
 
-    for (auto it = deferred.begin(); it != deferred.end();) {
-      it->first.reset_remove(vclock);
-      if (it->first.empty()) {
-        it = deferred.erase(it);
-      } else {
-        ++it;
-      }
+    deferred.reset_remove(vclock, clock);
+  }
+
+  auto validate_merge(const orswot_type &) const noexcept
+      -> std::optional<std::error_condition> {
+    return std::nullopt;
+  }
+
+  void merge(const orswot_type &other) { merge_state<false>(other); }
+
+  /// Same as merge(const orswot_type &), but takes over other's storage
+  /// instead of copying it.
+  void merge(orswot_type &&other) {
+    if (entries.empty() && deferred.empty() && clock.empty() &&
+        cloud.empty()) {
+      clock = std::move(other.clock);
+      cloud = std::move(other.cloud);
+      entries = std::move(other.entries);
+      deferred = std::move(other.deferred);
+      retrack();
+      return;
     }
+    merge_state<true>(other);
   }
 
-  void merge(const orswot_type &other) {
-    for (auto it = entries.begin(); it != entries.end();) {
-      if (!other.entries.contains(it->first)) {
-        if (other.clock >= it->second) {
-          it = entries.erase(it);
-        } else {
-          it->second.reset_remove(other.clock);
-          ++it;
-        }
-      } else {
-        ++it;
-      }
+  /// Builds the digest of the entries once and from then on keeps it up to
+  /// date as apply, merge and reset_remove change them, so digest() and
+  /// extract() at this depth no longer rehash every member. Entries changed
+  /// directly rather than through the replica are not accounted for.
+  void keep_digest(unsigned depth = merkle_digest::default_depth) {
+    tracked = build_digest(depth);
+  }
+
+  /// Digest of the entries bucketed by the hash of their member, see
+  /// merkle_digest.
+  auto digest(unsigned depth = merkle_digest::default_depth) const
+      -> merkle_digest {
+    if (tracked && tracked->depth() == depth)
+      return *tracked;
+    return build_digest(depth);
+  }
+
+  /// Entries in the buckets where theirs differs from our digest, with the
+  /// whole causal context and every deferred removal.
+  auto extract(const merkle_digest &theirs) const -> digest_delta<orswot_type> {
+    digest_delta<orswot_type> delta{{}, theirs.depth(), {}};
+    if (tracked && tracked->depth() == theirs.depth())
+      delta.buckets = tracked->differing(theirs);
+    else
+      delta.buckets = build_digest(theirs.depth()).differing(theirs);
+    delta.state.clock = clock;
+    delta.state.cloud = cloud;
+    delta.state.deferred = deferred;
+    for (const auto &[member, vclock] : entries)
+      if (delta.covers(std::hash<_Key>{}(member)))
+        delta.state.entries.emplace(member, vclock);
+    return delta;
+  }
+
+  /// Merges the result of extract(), leaving the buckets it does not cover
+  /// alone: their entries already agree with the other replica's.
+  void merge(const digest_delta<orswot_type> &delta) {
+    merge_state<false>(delta.state, [&](const _Key &member) {
+      return delta.covers(std::hash<_Key>{}(member));
+    });
+  }
+
+  /// Same as merge(const orswot_type &), with the walk over both entry maps
+  /// split into par.shards runs merged concurrently.
+  void merge(const orswot_type &other, parallel_merge par) {
+    // writes to a persistent map copy shared paths, which shards cannot do
+    // concurrently.
+    if constexpr (persistent_type<_Entries_map>) {
+      merge(other);
+      return;
     }
 
-    for (auto [entry, vclock] : other.entries) {
-      if (auto our_clock = entries.find(entry); our_clock != entries.end()) {
-        auto common = intersection(vclock, our_clock->second);
-        common.merge(vclock.clone_without(this->clock));
-        common.merge(our_clock->second.clone_without(other.clock));
-        if (common.empty()) {
-          entries.erase(entry);
+    auto shards = std::max<std::size_t>(par.shards, 1);
+    auto ours = details::split(entries.begin(), entries.end(), entries.size(),
+                               shards);
+    auto theirs = details::split(other.entries.begin(), other.entries.end(),
+                                 other.entries.size(), shards);
+
+    // clocks are updated in place by the shard owning them, only erasures
+    // and insertions change the map and wait for every shard to finish.
+    std::vector<std::vector<_Key>> erased(shards);
+    std::vector<std::vector<std::pair<_Key, member_clock>>> adopted(shards);
+    details::run_shards(shards, [&](std::size_t s) {
+      for (auto it = ours[s]; it != ours[s + 1]; ++it) {
+        if (auto their_clock = other.entries.find(it->first);
+            their_clock == other.entries.end()) {
+          if (other.cloud.dominates(other.clock, it->second)) {
+            erased[s].push_back(it->first);
+          } else {
+            it->second =
+                other.cloud.clone_without(std::move(it->second), other.clock);
+          }
         } else {
-          our_clock->second = common;
-        }
-      } else {
-        if (this->clock >= vclock) {
-        } else {
-          vclock.reset_remove(this->clock);
-          entries[entry] = vclock;
+          auto common = intersection(their_clock->second, it->second);
+          common.merge(cloud.clone_without(their_clock->second, clock));
+          common.merge(other.cloud.clone_without(it->second, other.clock));
+          if (common.empty()) {
+            erased[s].push_back(it->first);
+          } else {
+            it->second = std::move(common);
+          }
         }
       }
+
+      for (auto it = theirs[s]; it != theirs[s + 1]; ++it) {
+        if (entries.contains(it->first))
+          continue;
+        if (auto unseen = cloud.clone_without(it->second, clock);
+            !unseen.empty())
+          adopted[s].emplace_back(it->first, std::move(unseen));
+      }
+    });
+
+    for (const auto &keys : erased)
+      for (const auto &key : keys)
+        entries.erase(entries.find(key));
+    if constexpr (requires(std::size_t n) { entries.reserve(n); }) {
+      std::size_t count = entries.size();
+      for (const auto &members : adopted)
+        count += members.size();
+      entries.reserve(count);
     }
+    for (auto &members : adopted)
+      for (auto &[member, vclock] : members)
+        entries.emplace(std::move(member), std::move(vclock));
 
-    for (auto [rm_clock, members] : other.deferred)
-      this->apply_rm(members, rm_clock);
+    merge_context<false>(other);
+    // shards cannot share the digest, so it is rebuilt once they are done.
+    retrack();
+  }
 
-    this->clock.merge(other.clock);
-    apply_deferred();
+  auto contains(const _Key &member) const noexcept
+      -> read_context<bool, _Actor> {
+    if (auto it = entries.find(member); it != entries.end())
+      return read_context(clock, clock_cast<vector_clock>(it->second), true);
+    return read_context(clock, vector_clock(), false);
   }
 
-  auto contains(const _Key &member) noexcept -> read_context<bool, _Actor> {
-    return read_context(clock, entries[member], entries.contains(member));
+  /// Membership check that neither inserts nor copies a clock. Any type the
+  /// entries map can look up by works, e.g. std::string_view for
+  /// std::string members once its hash and key_equal are transparent.
+  template <typename _Lookup>
+    requires requires(const _Entries_map &m, const _Lookup &member) {
+      { m.find(member) } -> std::same_as<typename _Entries_map::const_iterator>;
+    }
+  auto lookup(const _Lookup &member) const noexcept
+      -> lookup_context<_Actor, member_clock> {
+    if (auto it = entries.find(member); it != entries.end())
+      return {&clock, &it->second};
+    return {&clock, nullptr};
   }
 
   auto read() const noexcept -> read_context<deferred_set, _Actor> {
     deferred_set val;
     std::transform(entries.begin(), entries.end(),
                    std::inserter(val, val.begin()),
-                   [](auto pair) { return pair.first; });
+                   [](const auto &pair) { return pair.first; });
     return read_context(clock, clock, val);
   }
 
+  /// Members read in place from entries, see read_view.
+  auto members() const noexcept {
+    return read_view(clock, std::views::keys(entries));
+  }
+
   auto read_ctx() const noexcept -> read_context<deferred_set, _Actor> {
     return read_context(clock, clock, deferred_set());
   }
@@ -206,11 +363,19 @@ struct orswot {
     return Add{std::move(ctx.dot), {member}};
   }
 
+  /// Adds every member of [first, last) under a single dot.
+  template <std::input_iterator _It>
+  auto add(add_context<_Actor> ctx, _It first, _It last) noexcept -> Op {
+    return Add{std::move(ctx.dot), {first, last}};
+  }
+
+  /// Adds member locally and returns the delta holding just the new dot.
   auto add(const _Actor &actor, const _Key &member) noexcept
       -> orswot_type {
+    auto op = add(read_ctx().derive_add_context(actor), member);
     orswot_type delta;
-    delta.apply(delta.add(read_ctx().derive_add_context(actor), member));
-    merge(delta);
+    delta.apply(op);
+    apply(op);
     return delta;
   }
 
@@ -218,13 +383,140 @@ struct orswot {
     return Rm{ctx.vector, {member}};
   }
 
+  template <std::input_iterator _It>
+  auto rm(remove_context<_Actor> ctx, _It first, _It last) noexcept -> Op {
+    return Rm{std::move(ctx.vector), {first, last}};
+  }
+
+  /// Removes member locally and returns the delta removing the dots it was
+  /// observed with, empty when member is absent.
   auto rm(const _Actor &_, const _Key &member) noexcept
       -> orswot_type {
     orswot_type delta;
-    delta.apply(delta.rm(read_ctx().derive_remove_context(), member));
-    merge(delta);
+    if (auto it = entries.find(member); it != entries.end()) {
+      auto op = rm(remove_context<_Actor>{clock_cast<vector_clock>(it->second)},
+                   member);
+      delta.apply(op);
+      apply(op);
+    }
     return delta;
   }
+
+private:
+  template <bool _Steal, typename _Other> void merge_state(_Other &other) {
+    merge_state<_Steal>(other, [](const _Key &) { return true; });
+  }
+
+  /// Merge leaving our entries outside within alone, other holding none
+  /// outside of it either.
+  template <bool _Steal, typename _Other, typename _Within>
+  void merge_state(_Other &other, _Within within) {
+    // entries are read through a const view and written only where they
+    // change, so persistent maps copy nothing for unchanged members.
+    const auto &ours = entries;
+    for (auto it = ours.begin(); it != ours.end();) {
+      const auto &[member, vclock] = *it;
+      if (!within(member) || other.entries.contains(member)) {
+        ++it;
+      } else if (other.cloud.dominates(other.clock, vclock)) {
+        untrack(member, vclock);
+        it = entries.erase(entries.find(member));
+      } else if (auto rest = other.cloud.clone_without(vclock, other.clock);
+                 rest != vclock) {
+        untrack(member, vclock);
+        auto changed = entries.find(member);
+        changed->second = std::move(rest);
+        track(changed->first, changed->second);
+        it = ++changed;
+      } else {
+        ++it;
+      }
+    }
+
+    for (auto it = other.entries.begin(); it != other.entries.end();) {
+      const auto &[entry, vclock] = *it;
+      if (auto our_clock = ours.find(entry); our_clock != ours.end()) {
+        auto common = intersection(vclock, our_clock->second);
+        common.merge(cloud.clone_without(vclock, this->clock));
+        common.merge(other.cloud.clone_without(our_clock->second, other.clock));
+        if (common.empty()) {
+          untrack(entry, our_clock->second);
+          entries.erase(entries.find(entry));
+        } else if (common != our_clock->second) {
+          untrack(entry, our_clock->second);
+          track(entry, common);
+          entries.find(entry)->second = std::move(common);
+        }
+      } else if constexpr (_Steal) {
+        auto unseen = cloud.clone_without(std::move(it->second), this->clock);
+        if constexpr (requires { other.entries.extract(it); }) {
+          if (!unseen.empty()) {
+            track(entry, unseen);
+            auto node = other.entries.extract(it++);
+            node.mapped() = std::move(unseen);
+            entries.insert(std::move(node));
+            continue;
+          }
+        } else if (!unseen.empty()) {
+          track(entry, unseen);
+          entries.emplace(entry, std::move(unseen));
+        }
+      } else {
+        if (auto unseen = cloud.clone_without(vclock, this->clock);
+            !unseen.empty()) {
+          track(entry, unseen);
+          entries.emplace(entry, std::move(unseen));
+        }
+      }
+      ++it;
+    }
+
+    merge_context<_Steal>(other);
+  }
+
+  template <bool _Steal, typename _Other> void merge_context(_Other &other) {
+    other.deferred.for_each([this](const auto &rm_clock, const auto &members) {
+      this->apply_rm(members, rm_clock);
+    });
+
+    this->clock.merge(other.clock);
+    if constexpr (_Steal)
+      cloud.merge(std::move(other.cloud));
+    else
+      cloud.merge(other.cloud);
+    cloud.compact(this->clock);
+    apply_deferred();
+  }
+
+  auto build_digest(unsigned depth) const -> merkle_digest {
+    merkle_digest tree(depth);
+    for (const auto &[member, vclock] : entries)
+      tree.add(std::hash<_Key>{}(member), std::hash<member_clock>{}(vclock));
+    return tree;
+  }
+
+  /// Accounts for member's clock in the kept digest once it was added or
+  /// changed; empty clocks are never kept in entries and never tracked.
+  void track(const _Key &member, const member_clock &vclock) noexcept {
+    if (tracked && !vclock.empty())
+      tracked->add(std::hash<_Key>{}(member),
+                   std::hash<member_clock>{}(vclock));
+  }
+
+  /// Undoes track(member, vclock) before the clock changes or is erased.
+  void untrack(const _Key &member, const member_clock &vclock) noexcept {
+    if (tracked && !vclock.empty())
+      tracked->remove(std::hash<_Key>{}(member),
+                      std::hash<member_clock>{}(vclock));
+  }
+
+  void retrack() {
+    if (tracked)
+      tracked = build_digest(tracked->depth());
+  }
+
+  /// Digest kept up to date with entries, see keep_digest.
+  std::optional<merkle_digest> tracked;
 };
 
 } // namespace crdt
@@ -0,0 +1,51 @@
+#ifndef PARALLEL_MERGE_H
+#define PARALLEL_MERGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace crdt {
+
+/// Tag selecting the merge overloads that split the entry walk into shards
+/// running on their own threads. Only the entry walk is sharded, clocks and
+/// deferred removals are reconciled on the calling thread afterwards, so the
+/// result is the same as the one of the sequential merge.
+struct parallel_merge {
+  std::size_t shards = std::max(1u, std::thread::hardware_concurrency());
+};
+
+namespace details {
+
+/// shards + 1 iterators cutting [first, last) into runs of even length.
+template <std::forward_iterator _It>
+auto split(_It first, _It last, std::size_t size, std::size_t shards)
+    -> std::vector<_It> {
+  std::vector<_It> bounds;
+  bounds.reserve(shards + 1);
+  bounds.push_back(first);
+  for (std::size_t s = 1; s < shards; ++s) {
+    std::advance(first, size * s / shards - size * (s - 1) / shards);
+    bounds.push_back(first);
+  }
+  bounds.push_back(last);
+  return bounds;
+}
+
+/// Calls f(s) for every s < shards, all but the first on a thread of its
+/// own, and returns once every call did.
+template <typename F> void run_shards(std::size_t shards, F &&f) {
+  std::vector<std::jthread> workers;
+  workers.reserve(shards - 1);
+  for (std::size_t s = 1; s < shards; ++s)
+    workers.emplace_back([&f, s] { f(s); });
+  f(0);
+}
+
+} // namespace details
+
+} // namespace crdt.
+
+#endif // PARALLEL_MERGE_H
@@ -0,0 +1,413 @@
+#ifndef PERSISTENT_MAP_H
+#define PERSISTENT_MAP_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace crdt {
+
+/// Hash array mapped trie sharing its nodes between copies. Copying the map
+/// is O(1), and a mutation only copies the nodes on the path to the touched
+/// entry that another copy still shares, which makes snapshots of a replica
+/// cheap. Dereferencing a mutable iterator unshares its path as well, so
+/// walk the map through const access wherever nothing is written.
+///
+/// Erasing never pulls entries up into a parent node, so the iteration order
+/// of the remaining entries is stable and erase(it) returns their successor.
+template <std::default_initializable _Key, std::default_initializable _Tp,
+          typename _Hash = std::hash<_Key>,
+          typename _KeyEqual = std::equal_to<_Key>>
+class persistent_map {
+  struct node;
+  using node_ptr = std::shared_ptr<node>;
+
+  static constexpr unsigned bits = 5;
+  static constexpr std::size_t fanout_mask = (1u << bits) - 1;
+  /// Depth at which the hash is used up and entries share a collision node.
+  static constexpr unsigned max_depth =
+      (std::numeric_limits<std::size_t>::digits + bits - 1) / bits;
+
+  /// A node on an iterator's path and the slot taken there: one of its
+  /// values, or past them the child the path continues in.
+  struct frame {
+    node *at = nullptr;
+    std::size_t pos = 0;
+  };
+
+public:
+  using key_type = _Key;
+  using mapped_type = _Tp;
+  using value_type = std::pair<_Key, _Tp>;
+  using size_type = std::size_t;
+  using hasher = _Hash;
+  using key_equal = _KeyEqual;
+
+  template <bool Const> class basic_iterator {
+    using map_pointer =
+        std::conditional_t<Const, const persistent_map *, persistent_map *>;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = persistent_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<Const, const value_type &, value_type &>;
+    using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+
+    basic_iterator() = default;
+    template <bool Other>
+    requires(Const && !Other)
+    basic_iterator(const basic_iterator<Other> &other)
+        : map(other.map), frames(other.frames), depth(other.depth) {}
+
+    auto operator*() const -> reference {
+      if constexpr (Const)
+        return current();
+      else
+        return map->unshare(*this);
+    }
+    auto operator->() const -> pointer { return &**this; }
+
+    auto operator++() -> basic_iterator & {
+      ++frames[depth - 1].pos;
+      settle();
+      return *this;
+    }
+    auto operator++(int) -> basic_iterator {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    friend auto operator==(const basic_iterator &l,
+                           const basic_iterator &r) noexcept -> bool {
+      if (l.depth != r.depth)
+        return false;
+      if (l.depth == 0)
+        return true;
+      const auto &lf = l.frames[l.depth - 1], &rf = r.frames[r.depth - 1];
+      return lf.at == rf.at && lf.pos == rf.pos;
+    }
+
+  private:
+    friend persistent_map;
+    friend basic_iterator<!Const>;
+
+    explicit basic_iterator(map_pointer map) : map(map) {}
+
+    auto current() const -> value_type & {
+      const auto &f = frames[depth - 1];
+      return f.at->values[f.pos];
+    }
+
+    /// Moves down or up until the path ends on a value or the walk is over.
+    void settle() {
+      while (depth > 0) {
+        auto &f = frames[depth - 1];
+        if (f.pos < f.at->values.size())
+          return;
+        if (auto child = f.pos - f.at->values.size();
+            child < f.at->children.size()) {
+          frames[depth++] = {f.at->children[child].get(), 0};
+          continue;
+        }
+        if (--depth > 0)
+          ++frames[depth - 1].pos;
+      }
+    }
+
+    map_pointer map = nullptr;
+    mutable std::array<frame, max_depth + 1> frames{};
+    std::size_t depth = 0;
+  };
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  persistent_map() = default;
+  persistent_map(const persistent_map &) = default;
+  persistent_map(persistent_map &&) = default;
+  persistent_map &operator=(const persistent_map &) = default;
+  persistent_map &operator=(persistent_map &&) = default;
+
+  /// O(1) copy sharing every node with this map.
+  auto snapshot() const noexcept -> persistent_map { return *this; }
+
+  auto operator==(const persistent_map &other) const -> bool
+  requires std::equality_comparable<_Tp> {
+    if (size() != other.size())
+      return false;
+    for (const auto &[key, value] : *this) {
+      auto it = other.find(key);
+      if (it == other.end() || !(it->second == value))
+        return false;
+    }
+    return true;
+  }
+
+  auto begin() noexcept -> iterator { return first<iterator>(this); }
+  auto end() noexcept -> iterator { return iterator(this); }
+  auto begin() const noexcept -> const_iterator {
+    return first<const_iterator>(this);
+  }
+  auto end() const noexcept -> const_iterator { return const_iterator(this); }
+  auto cbegin() const noexcept -> const_iterator { return begin(); }
+  auto cend() const noexcept -> const_iterator { return end(); }
+
+  auto size() const noexcept -> size_type { return count; }
+  auto empty() const noexcept -> bool { return count == 0; }
+  void clear() noexcept {
+    root.reset();
+    count = 0;
+  }
+
+  auto find(const _Key &key) noexcept -> iterator {
+    return locate<iterator>(this, key);
+  }
+  auto find(const _Key &key) const noexcept -> const_iterator {
+    return locate<const_iterator>(this, key);
+  }
+
+  auto contains(const _Key &key) const noexcept -> bool {
+    return find(key) != end();
+  }
+
+  auto operator[](const _Key &key) -> _Tp & {
+    return emplace(key).first.current().second;
+  }
+
+  template <typename... Args>
+  auto emplace(const _Key &key, Args &&...args) -> std::pair<iterator, bool> {
+    iterator it(this);
+    if (!insert_at(mutable_root(), 0, _Hash{}(key), key, it))
+      return {it, false};
+    if constexpr (sizeof...(Args) > 0)
+      it.current().second = _Tp(std::forward<Args>(args)...);
+    ++count;
+    return {it, true};
+  }
+
+  auto insert(const value_type &value) -> std::pair<iterator, bool> {
+    return emplace(value.first, value.second);
+  }
+
+  auto erase(const_iterator pos) -> iterator {
+    auto key = pos->first;
+    auto next = pos;
+    std::optional<_Key> following;
+    if (++next != cend())
+      following = next->first;
+
+    erase_at(mutable_root(), 0, _Hash{}(key), key);
+    --count;
+    return following ? find(*following) : end();
+  }
+  auto erase(iterator pos) -> iterator { return erase(const_iterator(pos)); }
+
+  auto erase(const _Key &key) -> size_type {
+    if (auto it = find(key); it != end()) {
+      erase(it);
+      return 1;
+    }
+    return 0;
+  }
+
+private:
+  struct node {
+    /// Slots holding a value, then slots holding a child; both vectors are
+    /// ordered by slot.
+    std::uint32_t datamap = 0;
+    std::uint32_t nodemap = 0;
+    std::vector<value_type> values;
+    std::vector<node_ptr> children;
+  };
+
+  static auto slot_of(std::size_t hash, unsigned depth) noexcept
+      -> std::uint32_t {
+    return std::uint32_t{1} << ((hash >> (bits * depth)) & fanout_mask);
+  }
+
+  static auto index_of(std::uint32_t map, std::uint32_t slot) noexcept
+      -> std::size_t {
+    return std::popcount(map & (slot - 1));
+  }
+
+  /// Replaces p by a private copy if another map shares it. use_count() is a
+  /// relaxed load, so once it reports sole ownership the acquire fence pairs
+  /// with the release decrement of a snapshot dropped on another thread,
+  /// ordering that thread's last reads before our writes to the node.
+  static auto unshared(node_ptr &p) -> node & {
+    if (p.use_count() > 1)
+      p = std::make_shared<node>(*p);
+    else
+      std::atomic_thread_fence(std::memory_order_acquire);
+    return *p;
+  }
+
+  auto mutable_root() -> node & {
+    if (!root)
+      root = std::make_shared<node>();
+    return unshared(root);
+  }
+
+  template <typename It, typename Map> static auto first(Map map) -> It {
+    It it(map);
+    if (map->root) {
+      it.frames[it.depth++] = {map->root.get(), 0};
+      it.settle();
+    }
+    return it;
+  }
+
+  template <typename It, typename Map>
+  static auto locate(Map map, const _Key &key) -> It {
+    It it(map);
+    if (!map->root)
+      return it;
+
+    auto hash = _Hash{}(key);
+    node *at = map->root.get();
+    for (unsigned depth = 0;; ++depth) {
+      if (depth == max_depth) {
+        for (std::size_t i = 0; i < at->values.size(); ++i) {
+          if (_KeyEqual{}(at->values[i].first, key)) {
+            it.frames[depth] = {at, i};
+            it.depth = depth + 1;
+            return it;
+          }
+        }
+        return It(map);
+      }
+
+      auto slot = slot_of(hash, depth);
+      if (at->datamap & slot) {
+        auto i = index_of(at->datamap, slot);
+        if (!_KeyEqual{}(at->values[i].first, key))
+          return It(map);
+        it.frames[depth] = {at, i};
+        it.depth = depth + 1;
+        return it;
+      }
+      if (!(at->nodemap & slot))
+        return It(map);
+
+      auto c = index_of(at->nodemap, slot);
+      it.frames[depth] = {at, at->values.size() + c};
+      at = at->children[c].get();
+    }
+  }
+
+  /// Path of it with every node on it private to this map.
+  auto unshare(const iterator &it) -> value_type & {
+    node_ptr *p = &root;
+    for (std::size_t depth = 0; depth < it.depth; ++depth) {
+      auto &f = it.frames[depth];
+      f.at = &unshared(*p);
+      if (depth + 1 < it.depth)
+        p = &f.at->children[f.pos - f.at->values.size()];
+    }
+    return it.current();
+  }
+
+  /// Finds or default inserts key below at, which is private to this map,
+  /// and points it at the entry. True when the entry was inserted.
+  auto insert_at(node &at, unsigned depth, std::size_t hash, const _Key &key,
+                 iterator &it) -> bool {
+    if (depth == max_depth) {
+      for (std::size_t i = 0; i < at.values.size(); ++i) {
+        if (_KeyEqual{}(at.values[i].first, key)) {
+          it.frames[depth] = {&at, i};
+          it.depth = depth + 1;
+          return false;
+        }
+      }
+      at.values.emplace_back(key, _Tp{});
+      it.frames[depth] = {&at, at.values.size() - 1};
+      it.depth = depth + 1;
+      return true;
+    }
+
+    auto slot = slot_of(hash, depth);
+    if (at.nodemap & slot) {
+      auto c = index_of(at.nodemap, slot);
+      it.frames[depth] = {&at, at.values.size() + c};
+      return insert_at(unshared(at.children[c]), depth + 1, hash, key, it);
+    }
+
+    auto i = index_of(at.datamap, slot);
+    if (!(at.datamap & slot)) {
+      at.datamap |= slot;
+      at.values.emplace(at.values.begin() + i, key, _Tp{});
+      it.frames[depth] = {&at, i};
+      it.depth = depth + 1;
+      return true;
+    }
+    if (_KeyEqual{}(at.values[i].first, key)) {
+      it.frames[depth] = {&at, i};
+      it.depth = depth + 1;
+      return false;
+    }
+
+    // the slot is taken by another key: push it one level down and insert
+    // next to it.
+    auto child = std::make_shared<node>();
+    auto resident = std::move(at.values[i]);
+    at.values.erase(at.values.begin() + i);
+    at.datamap ^= slot;
+    if (depth + 1 < max_depth)
+      child->datamap = slot_of(_Hash{}(resident.first), depth + 1);
+    child->values.push_back(std::move(resident));
+
+    auto c = index_of(at.nodemap, slot);
+    at.nodemap |= slot;
+    at.children.insert(at.children.begin() + c, child);
+    it.frames[depth] = {&at, at.values.size() + c};
+    return insert_at(*child, depth + 1, hash, key, it);
+  }
+
+  /// Removes key, which is present, below at, which is private to this map.
+  void erase_at(node &at, unsigned depth, std::size_t hash, const _Key &key) {
+    if (depth == max_depth) {
+      for (auto it = at.values.begin(); it != at.values.end(); ++it) {
+        if (_KeyEqual{}(it->first, key)) {
+          at.values.erase(it);
+          return;
+        }
+      }
+      return;
+    }
+
+    auto slot = slot_of(hash, depth);
+    if (at.datamap & slot) {
+      at.values.erase(at.values.begin() + index_of(at.datamap, slot));
+      at.datamap ^= slot;
+      return;
+    }
+
+    auto c = index_of(at.nodemap, slot);
+    auto &child = unshared(at.children[c]);
+    erase_at(child, depth + 1, hash, key);
+    if (child.values.empty() && child.children.empty()) {
+      at.children.erase(at.children.begin() + c);
+      at.nodemap ^= slot;
+    }
+  }
+
+  node_ptr root;
+  size_type count = 0;
+};
+
+} // namespace crdt.
+
+#endif // PERSISTENT_MAP_H
@@ -1,6 +1,7 @@
 #ifndef PNCOUNTER_H
 #define PNCOUNTER_H
 
+#include <cstdint>
 #include <optional>
 #include <utility>
 
@@ -88,7 +89,11 @@ template <actor_type A> struct pncounter {
     return op(n.operator+(std::move(a)), Dir::neg);
   }
 
-  auto read() const noexcept -> std::uint32_t { return p.read() - n.read(); }
+  /// Difference of both counters' totals, read in constant time.
+  auto read() const noexcept -> std::int64_t {
+    return static_cast<std::int64_t>(p.read()) -
+           static_cast<std::int64_t>(n.read());
+  }
 
 private:
   gcounter<A> &get_direction(Dir dir) noexcept {
@@ -0,0 +1,319 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (defined(__GNUC__) || defined(__clang__))
+#define CRDT_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace crdt::details::simd {
+
+/// Outcome of a pointwise comparison of two counter arrays.
+struct order {
+  bool greater = false;
+  bool less = false;
+};
+
+/// Element-wise kernels over dense counter arrays, all of them n elements
+/// long. Counters are unsigned, SIMD variants flip the sign bit to compare
+/// them with the signed 64-bit instructions.
+struct kernels {
+  /// dst[i] = max(dst[i], src[i]).
+  void (*merge)(std::uint64_t *dst, const std::uint64_t *src, std::size_t n);
+  /// dst[i] = 0 wherever src[i] >= dst[i].
+  void (*reset_remove)(std::uint64_t *dst, const std::uint64_t *src,
+                       std::size_t n);
+  /// dst[i] = a[i] == b[i] ? a[i] : 0.
+  void (*intersection)(std::uint64_t *dst, const std::uint64_t *a,
+                       const std::uint64_t *b, std::size_t n);
+  /// a[i] >= b[i] for every i.
+  bool (*dominates)(const std::uint64_t *a, const std::uint64_t *b,
+                    std::size_t n);
+  /// whether some a[i] > b[i] and whether some a[i] < b[i], stops once both
+  /// are known.
+  order (*compare)(const std::uint64_t *a, const std::uint64_t *b,
+                   std::size_t n);
+  const char *name;
+};
+
+namespace scalar {
+
+inline void merge(std::uint64_t *dst, const std::uint64_t *src,
+                  std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i)
+    dst[i] = dst[i] < src[i] ? src[i] : dst[i];
+}
+
+inline void reset_remove(std::uint64_t *dst, const std::uint64_t *src,
+                         std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i)
+    dst[i] = src[i] >= dst[i] ? 0 : dst[i];
+}
+
+inline void intersection(std::uint64_t *dst, const std::uint64_t *a,
+                         const std::uint64_t *b, std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i)
+    dst[i] = a[i] == b[i] ? a[i] : 0;
+}
+
+inline bool dominates(const std::uint64_t *a, const std::uint64_t *b,
+                      std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i)
+    if (a[i] < b[i])
+      return false;
+  return true;
+}
+
+inline order compare(const std::uint64_t *a, const std::uint64_t *b,
+                     std::size_t n) noexcept {
+  order res;
+  for (std::size_t i = 0; i < n && !(res.greater && res.less); ++i) {
+    res.greater |= a[i] > b[i];
+    res.less |= a[i] < b[i];
+  }
+  return res;
+}
+
+} // namespace scalar
+
+#ifdef CRDT_SIMD_X86
+
+namespace sse {
+
+#define CRDT_SSE __attribute__((target("sse4.2")))
+
+CRDT_SSE inline __m128i flip(__m128i v) noexcept {
+  return _mm_xor_si128(v, _mm_set1_epi64x(INT64_MIN));
+}
+
+/// unsigned a > b.
+CRDT_SSE inline __m128i gt(__m128i a, __m128i b) noexcept {
+  return _mm_cmpgt_epi64(flip(a), flip(b));
+}
+
+CRDT_SSE inline __m128i load(const std::uint64_t *p) noexcept {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+CRDT_SSE inline void store(std::uint64_t *p, __m128i v) noexcept {
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+}
+
+CRDT_SSE inline void merge(std::uint64_t *dst, const std::uint64_t *src,
+                           std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    auto a = load(dst + i), b = load(src + i);
+    store(dst + i, _mm_blendv_epi8(a, b, gt(b, a)));
+  }
+  scalar::merge(dst + i, src + i, n - i);
+}
+
+CRDT_SSE inline void reset_remove(std::uint64_t *dst, const std::uint64_t *src,
+                                  std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    auto a = load(dst + i), b = load(src + i);
+    store(dst + i, _mm_and_si128(a, gt(a, b)));
+  }
+  scalar::reset_remove(dst + i, src + i, n - i);
+}
+
+CRDT_SSE inline void intersection(std::uint64_t *dst, const std::uint64_t *a,
+                                  const std::uint64_t *b,
+                                  std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    auto x = load(a + i), y = load(b + i);
+    store(dst + i, _mm_and_si128(x, _mm_cmpeq_epi64(x, y)));
+  }
+  scalar::intersection(dst + i, a + i, b + i, n - i);
+}
+
+CRDT_SSE inline bool dominates(const std::uint64_t *a, const std::uint64_t *b,
+                               std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2)
+    if (_mm_movemask_epi8(gt(load(b + i), load(a + i))))
+      return false;
+  return scalar::dominates(a + i, b + i, n - i);
+}
+
+CRDT_SSE inline order compare(const std::uint64_t *a, const std::uint64_t *b,
+                              std::size_t n) noexcept {
+  order res;
+  std::size_t i = 0;
+  for (; i + 2 <= n && !(res.greater && res.less); i += 2) {
+    auto x = load(a + i), y = load(b + i);
+    res.greater |= _mm_movemask_epi8(gt(x, y)) != 0;
+    res.less |= _mm_movemask_epi8(gt(y, x)) != 0;
+  }
+  if (res.greater && res.less)
+    return res;
+  auto tail = scalar::compare(a + i, b + i, n - i);
+  return order{res.greater || tail.greater, res.less || tail.less};
+}
+
+#undef CRDT_SSE
+
+} // namespace sse
+
+namespace avx2 {
+
+#define CRDT_AVX2 __attribute__((target("avx2")))
+
+CRDT_AVX2 inline __m256i flip(__m256i v) noexcept {
+  return _mm256_xor_si256(v, _mm256_set1_epi64x(INT64_MIN));
+}
+
+/// unsigned a > b.
+CRDT_AVX2 inline __m256i gt(__m256i a, __m256i b) noexcept {
+  return _mm256_cmpgt_epi64(flip(a), flip(b));
+}
+
+CRDT_AVX2 inline __m256i load(const std::uint64_t *p) noexcept {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+CRDT_AVX2 inline void store(std::uint64_t *p, __m256i v) noexcept {
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+}
+
+CRDT_AVX2 inline void merge(std::uint64_t *dst, const std::uint64_t *src,
+                            std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto a = load(dst + i), b = load(src + i);
+    store(dst + i, _mm256_blendv_epi8(a, b, gt(b, a)));
+  }
+  scalar::merge(dst + i, src + i, n - i);
+}
+
+CRDT_AVX2 inline void reset_remove(std::uint64_t *dst,
+                                   const std::uint64_t *src,
+                                   std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto a = load(dst + i), b = load(src + i);
+    store(dst + i, _mm256_and_si256(a, gt(a, b)));
+  }
+  scalar::reset_remove(dst + i, src + i, n - i);
+}
+
+CRDT_AVX2 inline void intersection(std::uint64_t *dst, const std::uint64_t *a,
+                                   const std::uint64_t *b,
+                                   std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto x = load(a + i), y = load(b + i);
+    store(dst + i, _mm256_and_si256(x, _mm256_cmpeq_epi64(x, y)));
+  }
+  scalar::intersection(dst + i, a + i, b + i, n - i);
+}
+
+CRDT_AVX2 inline bool dominates(const std::uint64_t *a, const std::uint64_t *b,
+                                std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto behind = gt(load(b + i), load(a + i));
+    if (!_mm256_testz_si256(behind, behind))
+      return false;
+  }
+  return scalar::dominates(a + i, b + i, n - i);
+}
+
+CRDT_AVX2 inline order compare(const std::uint64_t *a, const std::uint64_t *b,
+                               std::size_t n) noexcept {
+  order res;
+  std::size_t i = 0;
+  for (; i + 4 <= n && !(res.greater && res.less); i += 4) {
+    auto x = load(a + i), y = load(b + i);
+    auto ahead = gt(x, y), behind = gt(y, x);
+    res.greater |= !_mm256_testz_si256(ahead, ahead);
+    res.less |= !_mm256_testz_si256(behind, behind);
+  }
+  if (res.greater && res.less)
+    return res;
+  auto tail = scalar::compare(a + i, b + i, n - i);
+  return order{res.greater || tail.greater, res.less || tail.less};
+}
+
+#undef CRDT_AVX2
+
+} // namespace avx2
+
+#endif // CRDT_SIMD_X86
+
+inline constexpr kernels scalar_kernels{
+    scalar::merge,     scalar::reset_remove, scalar::intersection,
+    scalar::dominates, scalar::compare,      "scalar"};
+
+#ifdef CRDT_SIMD_X86
+inline constexpr kernels sse_kernels{sse::merge,     sse::reset_remove,
+                                     sse::intersection, sse::dominates,
+                                     sse::compare,   "sse4.2"};
+
+inline constexpr kernels avx2_kernels{avx2::merge,     avx2::reset_remove,
+                                      avx2::intersection, avx2::dominates,
+                                      avx2::compare,   "avx2"};
+#endif
+
+/// Probing of the 16 control bytes of a flat_table group: bit i of a result
+/// is set when byte i matches. SSE2 is part of every x86-64 CPU, so unlike
+/// the kernels above it is used without runtime detection.
+namespace group {
+
+inline constexpr std::size_t width = 16;
+
+/// Bytes equal to tag.
+inline auto match(const std::int8_t *ctrl, std::int8_t tag) noexcept
+    -> std::uint32_t {
+#if defined(CRDT_SIMD_X86) && defined(__SSE2__)
+  auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+  return static_cast<std::uint32_t>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(tag))));
+#else
+  std::uint32_t mask = 0;
+  for (std::size_t i = 0; i < width; ++i)
+    mask |= static_cast<std::uint32_t>(ctrl[i] == tag) << i;
+  return mask;
+#endif
+}
+
+/// Bytes with the sign bit set.
+inline auto match_negative(const std::int8_t *ctrl) noexcept -> std::uint32_t {
+#if defined(CRDT_SIMD_X86) && defined(__SSE2__)
+  return static_cast<std::uint32_t>(_mm_movemask_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))));
+#else
+  std::uint32_t mask = 0;
+  for (std::size_t i = 0; i < width; ++i)
+    mask |= static_cast<std::uint32_t>(ctrl[i] < 0) << i;
+  return mask;
+#endif
+}
+
+} // namespace group
+
+/// Best kernel set the running CPU supports, detected once.
+inline auto active() noexcept -> const kernels & {
+  static const kernels &selected = []() -> const kernels & {
+#ifdef CRDT_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      return avx2_kernels;
+    if (__builtin_cpu_supports("sse4.2"))
+      return sse_kernels;
+#endif
+    return scalar_kernels;
+  }();
+  return selected;
+}
+
+} // namespace crdt::details::simd
+
+#endif // SIMD_H
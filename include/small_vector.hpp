@@ -0,0 +1,195 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace crdt {
+
+/// Contiguous sequence which keeps up to N elements inline and spills into
+/// heap storage only once it grows past that.
+template <std::default_initializable T, std::size_t N> class small_vector {
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T &;
+  using const_reference = const T &;
+  using iterator = T *;
+  using const_iterator = const T *;
+
+  small_vector() = default;
+  small_vector(std::initializer_list<T> list) {
+    reserve(list.size());
+    for (const auto &v : list)
+      push_back(v);
+  }
+  small_vector(const small_vector &) = default;
+  small_vector(small_vector &&other) noexcept
+      : inline_(std::move(other.inline_)), heap_(std::move(other.heap_)),
+        size_(std::exchange(other.size_, 0)),
+        spilled_(std::exchange(other.spilled_, false)) {}
+
+  small_vector &operator=(const small_vector &) = default;
+  small_vector &operator=(small_vector &&other) noexcept {
+    inline_ = std::move(other.inline_);
+    heap_ = std::move(other.heap_);
+    size_ = std::exchange(other.size_, 0);
+    spilled_ = std::exchange(other.spilled_, false);
+    return *this;
+  }
+
+  auto operator==(const small_vector &other) const noexcept -> bool {
+    return std::equal(begin(), end(), other.begin(), other.end());
+  }
+
+  auto data() noexcept -> T * {
+    return spilled_ ? heap_.data() : inline_.data();
+  }
+  auto data() const noexcept -> const T * {
+    return spilled_ ? heap_.data() : inline_.data();
+  }
+
+  auto begin() noexcept -> iterator { return data(); }
+  auto end() noexcept -> iterator { return data() + size(); }
+  auto begin() const noexcept -> const_iterator { return data(); }
+  auto end() const noexcept -> const_iterator { return data() + size(); }
+  auto cbegin() const noexcept -> const_iterator { return begin(); }
+  auto cend() const noexcept -> const_iterator { return end(); }
+
+  auto size() const noexcept -> size_type {
+    return spilled_ ? heap_.size() : size_;
+  }
+  auto empty() const noexcept -> bool { return size() == 0; }
+  auto capacity() const noexcept -> size_type {
+    return spilled_ ? heap_.capacity() : N;
+  }
+
+  auto operator[](size_type i) noexcept -> T & { return data()[i]; }
+  auto operator[](size_type i) const noexcept -> const T & {
+    return data()[i];
+  }
+  auto front() noexcept -> T & { return *begin(); }
+  auto front() const noexcept -> const T & { return *begin(); }
+  auto back() noexcept -> T & { return *(end() - 1); }
+  auto back() const noexcept -> const T & { return *(end() - 1); }
+
+  void reserve(size_type n) {
+    if (n > capacity())
+      spill(n);
+  }
+
+  /// Moves the elements back inline once they fit there again, releasing
+  /// the heap storage.
+  void compact() noexcept {
+    if (!spilled_ || heap_.size() > N)
+      return;
+    std::move(heap_.begin(), heap_.end(), inline_.begin());
+    size_ = heap_.size();
+    heap_ = std::vector<T>();
+    spilled_ = false;
+  }
+
+  void clear() noexcept {
+    std::fill(inline_.begin(), inline_.begin() + size_, T{});
+    heap_.clear();
+    size_ = 0;
+    spilled_ = false;
+  }
+
+  template <typename... Args> auto emplace_back(Args &&...args) -> T & {
+    if (spilled_)
+      return heap_.emplace_back(std::forward<Args>(args)...);
+    if (size_ == N) {
+      T value(std::forward<Args>(args)...);
+      spill(2 * N + 1);
+      return heap_.emplace_back(std::move(value));
+    }
+    inline_[size_] = T(std::forward<Args>(args)...);
+    return inline_[size_++];
+  }
+
+  void push_back(const T &v) { emplace_back(v); }
+  void push_back(T &&v) { emplace_back(std::move(v)); }
+
+  void pop_back() noexcept {
+    if (spilled_) {
+      heap_.pop_back();
+    } else {
+      inline_[--size_] = T{};
+    }
+  }
+
+  template <typename... Args>
+  auto emplace(const_iterator pos, Args &&...args) -> iterator {
+    auto idx = static_cast<size_type>(pos - begin());
+    T value(std::forward<Args>(args)...);
+    if (!spilled_ && size_ == N)
+      spill(2 * N + 1);
+    if (spilled_) {
+      auto it = heap_.emplace(heap_.begin() + idx, std::move(value));
+      return heap_.data() + (it - heap_.begin());
+    }
+
+    std::move_backward(inline_.begin() + idx, inline_.begin() + size_,
+                       inline_.begin() + size_ + 1);
+    inline_[idx] = std::move(value);
+    ++size_;
+    return inline_.data() + idx;
+  }
+
+  auto insert(const_iterator pos, const T &v) -> iterator {
+    return emplace(pos, v);
+  }
+  auto insert(const_iterator pos, T &&v) -> iterator {
+    return emplace(pos, std::move(v));
+  }
+
+  auto erase(const_iterator first, const_iterator last) noexcept -> iterator {
+    auto idx = static_cast<size_type>(first - begin());
+    auto count = static_cast<size_type>(last - first);
+    if (spilled_) {
+      heap_.erase(heap_.begin() + idx, heap_.begin() + idx + count);
+      return heap_.data() + idx;
+    }
+
+    std::move(inline_.begin() + idx + count, inline_.begin() + size_,
+              inline_.begin() + idx);
+    std::fill(inline_.begin() + size_ - count, inline_.begin() + size_, T{});
+    size_ -= count;
+    return inline_.data() + idx;
+  }
+
+  auto erase(const_iterator pos) noexcept -> iterator {
+    return erase(pos, pos + 1);
+  }
+
+private:
+  void spill(size_type n) {
+    if (spilled_) {
+      heap_.reserve(n);
+      return;
+    }
+    heap_.reserve(std::max(n, size_));
+    std::move(inline_.begin(), inline_.begin() + size_,
+              std::back_inserter(heap_));
+    std::fill(inline_.begin(), inline_.begin() + size_, T{});
+    size_ = 0;
+    spilled_ = true;
+  }
+
+  std::array<T, N> inline_{};
+  std::vector<T> heap_;
+  size_type size_ = 0;
+  bool spilled_ = false;
+};
+
+} // namespace crdt.
+
+#endif // SMALL_VECTOR_H
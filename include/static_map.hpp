@@ -0,0 +1,146 @@
+#ifndef STATIC_MAP_H
+#define STATIC_MAP_H
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include <crdt_traits.hpp>
+#include <dense_map.hpp>
+#include <version_vector.hpp>
+
+namespace crdt {
+
+/// Replica index of a system with a fixed, compile-time known number of
+/// replicas N.
+template <std::size_t N> struct replica {
+  static_assert(N > 0, "replica set must not be empty");
+
+  std::uint32_t index = 0;
+
+  constexpr replica() = default;
+  constexpr explicit replica(std::size_t i)
+      : index(static_cast<std::uint32_t>(i)) {}
+
+  constexpr explicit operator std::size_t() const noexcept { return index; }
+
+  constexpr auto operator<=>(const replica &) const noexcept = default;
+};
+
+} // namespace crdt.
+
+namespace std {
+
+template <std::size_t N> struct hash<crdt::replica<N>> {
+  auto operator()(const crdt::replica<N> &r) const noexcept -> std::size_t {
+    return std::hash<std::uint32_t>{}(r.index);
+  }
+};
+
+} // namespace std.
+
+namespace crdt {
+
+/// Clock storage for exactly N replicas held inline in a std::array, so
+/// clocks are trivially copyable, allocation free and version_vector
+/// unrolls its operations over the counters at compile time. As with
+/// dense_map a zero counter means the replica is absent.
+template <std::size_t N> class static_map {
+public:
+  using key_type = replica<N>;
+  using mapped_type = std::uint64_t;
+  using value_type = std::pair<const key_type, std::uint64_t>;
+  using size_type = std::size_t;
+  using iterator = details::counter_iterator<key_type, false>;
+  using const_iterator = details::counter_iterator<key_type, true>;
+
+  static constexpr size_type static_extent = N;
+
+  constexpr bool operator==(const static_map &) const noexcept = default;
+
+  constexpr auto begin() noexcept -> iterator { return iterator(data(), 0, N); }
+  constexpr auto end() noexcept -> iterator { return iterator(data(), N, N); }
+  constexpr auto begin() const noexcept -> const_iterator {
+    return const_iterator(data(), 0, N);
+  }
+  constexpr auto end() const noexcept -> const_iterator {
+    return const_iterator(data(), N, N);
+  }
+  constexpr auto cbegin() const noexcept -> const_iterator { return begin(); }
+  constexpr auto cend() const noexcept -> const_iterator { return end(); }
+
+  constexpr auto size() const noexcept -> size_type {
+    size_type n = 0;
+    for (auto counter : counters)
+      n += counter != 0;
+    return n;
+  }
+  constexpr auto empty() const noexcept -> bool { return size() == 0; }
+  constexpr void clear() noexcept { counters.fill(0); }
+
+  constexpr auto find(const key_type &key) noexcept -> iterator {
+    auto i = slot(key);
+    return counters[i] != 0 ? iterator(data(), i, N) : end();
+  }
+  constexpr auto find(const key_type &key) const noexcept -> const_iterator {
+    auto i = slot(key);
+    return counters[i] != 0 ? const_iterator(data(), i, N) : end();
+  }
+
+  constexpr auto contains(const key_type &key) const noexcept -> bool {
+    return counters[slot(key)] != 0;
+  }
+
+  constexpr auto operator[](const key_type &key) noexcept -> std::uint64_t & {
+    return counters[slot(key)];
+  }
+
+  constexpr auto emplace(const key_type &key, std::uint64_t counter) noexcept
+      -> std::pair<iterator, bool> {
+    auto i = slot(key);
+    if (counters[i] != 0)
+      return {iterator(data(), i, N), false};
+    counters[i] = counter;
+    return {iterator(data(), i, N), true};
+  }
+
+  constexpr auto erase(const_iterator pos) noexcept -> iterator {
+    auto i = pos.slot();
+    counters[i] = 0;
+    return iterator(data(), i, N);
+  }
+
+  constexpr auto erase(const key_type &key) noexcept -> size_type {
+    auto &counter = counters[slot(key)];
+    return std::exchange(counter, 0) != 0;
+  }
+
+  constexpr auto extent() const noexcept -> size_type { return N; }
+  /// Storage is fixed, every replica slot already exists.
+  constexpr void grow(size_type) noexcept {}
+  constexpr auto data() noexcept -> std::uint64_t * { return counters.data(); }
+  constexpr auto data() const noexcept -> const std::uint64_t * {
+    return counters.data();
+  }
+
+private:
+  static constexpr auto slot(const key_type &key) noexcept -> size_type {
+    return static_cast<size_type>(key);
+  }
+
+  std::array<std::uint64_t, N> counters{};
+};
+
+template <std::size_t N> struct dots_map_traits<replica<N>> {
+  using type = static_map<N>;
+};
+
+template <std::size_t N>
+using static_version_vector = version_vector<replica<N>>;
+
+} // namespace crdt.
+
+#endif // STATIC_MAP_H
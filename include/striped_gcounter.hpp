@@ -0,0 +1,92 @@
+#ifndef STRIPED_GCOUNTER_H
+#define STRIPED_GCOUNTER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+#include <crdt_traits.hpp>
+#include <gcounter.hpp>
+
+namespace crdt {
+
+/// Front-end counting the local actor's increments of a gcounter from many
+/// threads. Each thread bumps a relaxed atomic in a stripe of its own cache
+/// line, so an increment takes no lock, allocates nothing and does not
+/// contend with other threads' increments. flush() folds every pending
+/// increment into the underlying gcounter as a single dot and returns the
+/// delta replicating it.
+template <actor_type _Actor, std::size_t _Stripes = 16> class striped_gcounter {
+public:
+  using gcounter_type = gcounter<_Actor>;
+
+  explicit striped_gcounter(_Actor actor) : actor(std::move(actor)) {}
+
+  void inc(std::uint64_t steps = 1) noexcept {
+    stripes[stripe_index()].count.fetch_add(steps, std::memory_order_relaxed);
+  }
+
+  /// Increments not flushed yet.
+  auto pending() const noexcept -> std::uint64_t {
+    std::uint64_t sum = 0;
+    for (const auto &s : stripes)
+      sum += s.count.load(std::memory_order_relaxed);
+    return sum;
+  }
+
+  /// Folds the pending increments into the counter under one new dot of
+  /// the local actor and returns the delta holding it, empty when nothing
+  /// was pending. Increments racing with a flush land in this one or the
+  /// next.
+  auto flush() -> gcounter_type {
+    std::lock_guard guard(lock);
+    std::uint64_t sum = 0;
+    for (auto &s : stripes)
+      sum += s.count.exchange(0, std::memory_order_relaxed);
+    if (sum == 0)
+      return {};
+    return counter.inc(actor, sum);
+  }
+
+  /// Flushed total plus the increments still pending.
+  auto read() const -> std::uint64_t {
+    std::lock_guard guard(lock);
+    return counter.read() + pending();
+  }
+
+  /// Copy of the flushed counter, ready to be shipped or merged elsewhere.
+  auto state() const -> gcounter_type {
+    std::lock_guard guard(lock);
+    return counter;
+  }
+
+  void merge(const gcounter_type &other) {
+    std::lock_guard guard(lock);
+    counter.merge(other);
+  }
+
+private:
+  struct alignas(64) stripe {
+    std::atomic<std::uint64_t> count{0};
+  };
+
+  /// Threads are handed stripes round robin the first time they count.
+  static auto stripe_index() noexcept -> std::size_t {
+    static std::atomic<std::size_t> next{0};
+    static thread_local const std::size_t index =
+        next.fetch_add(1, std::memory_order_relaxed) % _Stripes;
+    return index;
+  }
+
+  _Actor actor;
+  std::array<stripe, _Stripes> stripes;
+  mutable std::mutex lock;
+  gcounter_type counter;
+};
+
+} // namespace crdt.
+
+#endif // STRIPED_GCOUNTER_H
@@ -3,6 +3,8 @@
 
 #include <algorithm>
 #include <compare>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <numeric>
@@ -11,9 +13,22 @@
 
 #include <crdt_traits.hpp>
 #include <dot.hpp>
+#include <simd.hpp>
 
 namespace crdt {
 
+namespace details {
+
+/// Calls f(std::integral_constant<std::size_t, I>{}) for every I < N as one
+/// unrolled expression.
+template <std::size_t N, typename F> constexpr void unroll(F &&f) {
+  [&]<std::size_t... I>(std::index_sequence<I...>) {
+    (f(std::integral_constant<std::size_t, I>{}), ...);
+  }(std::make_index_sequence<N>{});
+}
+
+} // namespace details
+
 template <actor_type _Actor,
           iterable_assiative_type<_Actor, std::uint64_t> _Map>
 struct version_vector {
@@ -26,6 +41,15 @@ struct version_vector {
   version_vector(const version_vector<_Actor, _Map> &) = default;
   version_vector(version_vector<_Actor, _Map> &&) = default;
 
+  /// Same clock held in another dots backend.
+  template <iterable_assiative_type<_Actor, std::uint64_t> _Other>
+    requires(!std::same_as<_Other, _Map>)
+  explicit version_vector(const version_vector<_Actor, _Other> &other) {
+    for (const auto &[actor, counter] : other.dots)
+      if (counter != 0)
+        dots[actor] = counter;
+  }
+
   version_vector<_Actor, _Map> &
   operator=(const version_vector<_Actor, _Map> &) = default;
   version_vector<_Actor, _Map> &
@@ -33,60 +57,125 @@ struct version_vector {
   version_vector<_Actor, _Map> &
   operator=(version_vector<_Actor, _Map> &) = default;
 
-  auto operator<=>(const version_vector<_Actor, _Map> &other) const noexcept {
-    auto all_gt = [](const version_vector<_Actor, _Map> &left,
-                     const version_vector<_Actor, _Map> &right) -> bool {
+  constexpr auto operator<=>(const version_vector<_Actor, _Map> &other) const noexcept {
+    if constexpr (fixed_type<_Map>) {
+      bool greater = false, less = false;
+      details::unroll<_Map::static_extent>([&](auto i) {
+        greater |= dots.data()[i] > other.dots.data()[i];
+        less |= dots.data()[i] < other.dots.data()[i];
+      });
+      return to_ordering(greater, less);
+    } else if constexpr (dense_type<_Map>) {
+      return compare_dense(other);
+    } else if constexpr (ordered_type<_Map>) {
+      return compare_sorted(other);
+    } else {
+      return compare_hashed(other);
+    }
+  }
+
+  /// True when this clock has seen everything other has seen; cheaper than
+  /// going through operator<=> as only other's entries are visited.
+  constexpr auto dominates(const version_vector<_Actor, _Map> &other) const noexcept
+      -> bool {
+    if constexpr (fixed_type<_Map>) {
+      bool behind = false;
+      details::unroll<_Map::static_extent>([&](auto i) {
+        behind |= dots.data()[i] < other.dots.data()[i];
+      });
+      return !behind;
+    } else if constexpr (dense_type<_Map>) {
+      auto common = std::min(dots.extent(), other.dots.extent());
+      return details::simd::active().dominates(dots.data(), other.dots.data(),
+                                               common) &&
+             std::all_of(other.dots.data() + common,
+                         other.dots.data() + other.dots.extent(),
+                         [](std::uint64_t c) { return c == 0; });
+    } else if constexpr (ordered_type<_Map>) {
+      auto comp = dots.key_comp();
+      auto ours = dots.begin();
+      for (const auto &[actor, counter] : other.dots) {
+        while (ours != dots.end() && comp(ours->first, actor))
+          ++ours;
+        if (ours != dots.end() && !comp(actor, ours->first)) {
+          if (ours->second < counter)
+            return false;
+        } else if (counter > 0) {
+          return false;
+        }
+      }
+      return true;
+    } else {
       return std::all_of(
-          right.dots.begin(), right.dots.end(),
-          [&left](const auto &d) { return left.get(d.first) >= d.second; });
-    };
-
-    if (this->dots.size() == other.dots.size() &&
-        std::equal(this->dots.begin(), this->dots.end(), other.dots.begin())) {
-      return std::partial_ordering::equivalent;
-    } else if (all_gt(*this, other)) {
-      return std::partial_ordering::greater;
-    } else if (all_gt(other, *this)) {
-      return std::partial_ordering::less;
+          other.dots.begin(), other.dots.end(),
+          [this](const auto &d) { return get(d.first) >= d.second; });
     }
+  }
 
-    return std::partial_ordering::unordered;
+  constexpr auto concurrent_with(const version_vector<_Actor, _Map> &other) const noexcept
+      -> bool {
+    return (*this <=> other) == std::partial_ordering::unordered;
   }
 
   bool
   operator==(const version_vector<_Actor, _Map> &) const noexcept = default;
 
-  void reset_remove(const version_vector<_Actor, _Map> &other) noexcept {
-    for (auto [actor, counter] : other.dots) {
-      if (auto dot = dots.find(actor);
-          dot != dots.end() && counter >= dot->second) {
-        dots.erase(dot);
+  constexpr void reset_remove(const version_vector<_Actor, _Map> &other) noexcept {
+    if constexpr (fixed_type<_Map>) {
+      details::unroll<_Map::static_extent>([&](auto i) {
+        auto &counter = dots.data()[i];
+        counter = other.dots.data()[i] >= counter ? 0 : counter;
+      });
+    } else if constexpr (dense_type<_Map>) {
+      details::simd::active().reset_remove(
+          dots.data(), other.dots.data(),
+          std::min(dots.extent(), other.dots.extent()));
+    } else if constexpr (ordered_type<_Map>) {
+      auto comp = dots.key_comp();
+      auto it = dots.begin();
+      auto theirs = other.dots.begin();
+      while (it != dots.end() && theirs != other.dots.end()) {
+        if (comp(it->first, theirs->first)) {
+          ++it;
+        } else if (comp(theirs->first, it->first)) {
+          ++theirs;
+        } else {
+          it = theirs->second >= it->second ? dots.erase(it) : std::next(it);
+          ++theirs;
+        }
+      }
+    } else {
+      for (const auto &[actor, counter] : other.dots) {
+        if (auto dot = dots.find(actor);
+            dot != dots.end() && counter >= dot->second) {
+          dots.erase(dot);
+        }
       }
     }
   }
 
-  bool empty() const noexcept { return dots.empty(); }
+  constexpr bool empty() const noexcept { return dots.empty(); }
 
-  auto get(const _Actor &a) const noexcept -> std::uint64_t {
+  constexpr auto get(const _Actor &a) const noexcept -> std::uint64_t {
     auto it = dots.find(a);
     if (it == dots.end())
       return 0;
     return it->second;
   }
 
-  auto get_dot(const _Actor &a) const noexcept -> dot<_Actor> {
+  constexpr auto get_dot(const _Actor &a) const noexcept -> dot<_Actor> {
     if (auto it = dots.find(a); it != dots.end())
       return dot(it->first, it->second);
     return dot(a, 0);
   }
 
-  auto inc(const _Actor &a) const noexcept -> dot<_Actor> {
+  constexpr auto inc(const _Actor &a) const noexcept -> dot<_Actor> {
     return ++get_dot(a);
   }
 
-  auto validate_op(const Op &op) const noexcept
+  constexpr auto validate_op(const Op &op) const noexcept
       -> std::optional<std::error_condition> {
-    auto next_counter = dots.find(op.actor)->second + 1;
+    auto next_counter = get(op.actor) + 1;
     if (op.counter > next_counter) {
       return std::make_error_condition(std::errc::invalid_argument);
     }
@@ -94,40 +183,198 @@ struct version_vector {
     return std::nullopt;
   }
 
-  void apply(const Op &op) noexcept {
+  constexpr void apply(const Op &op) noexcept {
     if (auto counter = get(op.actor); counter <= op.counter) {
       dots[op.actor] = op.counter;
     }
   }
 
-  auto validate_merge(const version_vector<_Actor, _Map> &) const noexcept
+  constexpr auto validate_merge(const version_vector<_Actor, _Map> &) const noexcept
       -> std::optional<std::error_condition> {
     return std::nullopt;
   }
 
-  void merge(const version_vector<_Actor, _Map> &other) noexcept {
-    for (const auto &[actor, counter] : other.dots)
-      apply(dot{actor, counter});
+  constexpr void merge(const version_vector<_Actor, _Map> &other) noexcept {
+    if constexpr (fixed_type<_Map>) {
+      details::unroll<_Map::static_extent>([&](auto i) {
+        auto &counter = dots.data()[i];
+        counter = std::max(counter, other.dots.data()[i]);
+      });
+    } else if constexpr (dense_type<_Map>) {
+      dots.grow(other.dots.extent());
+      details::simd::active().merge(dots.data(), other.dots.data(),
+                                    other.dots.extent());
+    } else if constexpr (ordered_type<_Map>) {
+      auto comp = dots.key_comp();
+      auto it = dots.begin();
+      for (const auto &[actor, counter] : other.dots) {
+        while (it != dots.end() && comp(it->first, actor))
+          ++it;
+        if (it != dots.end() && !comp(actor, it->first)) {
+          it->second = std::max(it->second, counter);
+        } else {
+          it = dots.emplace_hint(it, actor, counter);
+        }
+        ++it;
+      }
+    } else {
+      for (const auto &[actor, counter] : other.dots)
+        apply(dot{actor, counter});
+    }
   }
 
-  auto clone_without(version_vector<_Actor, _Map> base_clock) const noexcept
+  constexpr auto clone_without(version_vector<_Actor, _Map> base_clock) const noexcept
       -> version_vector<_Actor, _Map> {
     version_vector<_Actor, _Map> cloned(*this);
     cloned.reset_remove(base_clock);
     return cloned;
   }
+
+private:
+  constexpr static auto to_ordering(bool greater, bool less) noexcept
+      -> std::partial_ordering {
+    if (greater && less)
+      return std::partial_ordering::unordered;
+    if (greater)
+      return std::partial_ordering::greater;
+    if (less)
+      return std::partial_ordering::less;
+    return std::partial_ordering::equivalent;
+  }
+
+  constexpr auto compare_hashed(const version_vector<_Actor, _Map> &other) const noexcept
+      -> std::partial_ordering {
+    bool greater = false, less = false;
+    std::size_t shared = 0;
+    // clocks with the same history usually iterate in the same order, so
+    // pair entries positionally and only probe once the orders diverge.
+    auto aligned = other.dots.begin();
+    for (const auto &[actor, counter] : dots) {
+      std::uint64_t theirs = 0;
+      if (aligned != other.dots.end() && aligned->first == actor) {
+        theirs = aligned->second;
+        ++aligned, ++shared;
+      } else if (auto it = other.dots.find(actor); it != other.dots.end()) {
+        theirs = it->second;
+        aligned = other.dots.end(), ++shared;
+      } else {
+        aligned = other.dots.end();
+      }
+      greater |= counter > theirs;
+      less |= counter < theirs;
+      if (greater && less)
+        return std::partial_ordering::unordered;
+    }
+
+    // only actors we have never heard of are left to make us smaller.
+    if (!less && shared != other.dots.size()) {
+      less = std::any_of(other.dots.begin(), other.dots.end(),
+                         [this](const auto &d) {
+                           return d.second > 0 && !dots.contains(d.first);
+                         });
+    }
+
+    return to_ordering(greater, less);
+  }
+
+  constexpr auto compare_dense(const version_vector<_Actor, _Map> &other) const noexcept
+      -> std::partial_ordering {
+    auto common = std::min(dots.extent(), other.dots.extent());
+    auto [greater, less] = details::simd::active().compare(
+        dots.data(), other.dots.data(), common);
+    auto non_zero = [](std::uint64_t c) { return c != 0; };
+    greater = greater || std::any_of(dots.data() + common,
+                                     dots.data() + dots.extent(), non_zero);
+    less = less || std::any_of(other.dots.data() + common,
+                               other.dots.data() + other.dots.extent(),
+                               non_zero);
+    return to_ordering(greater, less);
+  }
+
+  constexpr auto compare_sorted(const version_vector<_Actor, _Map> &other) const noexcept
+      -> std::partial_ordering {
+    auto comp = dots.key_comp();
+    bool greater = false, less = false;
+    auto ours = dots.begin();
+    auto theirs = other.dots.begin();
+    while (ours != dots.end() && theirs != other.dots.end()) {
+      // tight loop over the common case of both clocks knowing the same actors.
+      for (; ours != dots.end() && theirs != other.dots.end() &&
+             ours->first == theirs->first;
+           ++ours, ++theirs) {
+        if (ours->second == theirs->second)
+          continue;
+        (ours->second > theirs->second ? greater : less) = true;
+        if (greater && less)
+          return std::partial_ordering::unordered;
+      }
+      if (ours == dots.end() || theirs == other.dots.end())
+        break;
+
+      if (comp(ours->first, theirs->first)) {
+        greater |= ours->second > 0, ++ours;
+      } else {
+        less |= theirs->second > 0, ++theirs;
+      }
+    }
+    for (; ours != dots.end() && !greater; ++ours)
+      greater = ours->second > 0;
+    for (; theirs != other.dots.end() && !less; ++theirs)
+      less = theirs->second > 0;
+
+    return to_ordering(greater, less);
+  }
 };
 
 template <actor_type A, iterable_assiative_type<A, std::uint64_t> T>
-auto intersection(const version_vector<A, T> &left,
+constexpr auto intersection(const version_vector<A, T> &left,
                   const version_vector<A, T> &right) noexcept
     -> version_vector<A, T> {
   version_vector<A, T> res;
-  std::set_intersection(left.dots.begin(), left.dots.end(), right.dots.begin(),
-                        right.dots.end(), std::inserter(res.dots, res.dots.begin()));
+  if constexpr (fixed_type<T>) {
+    details::unroll<T::static_extent>([&](auto i) {
+      auto counter = left.dots.data()[i];
+      res.dots.data()[i] = counter == right.dots.data()[i] ? counter : 0;
+    });
+  } else if constexpr (dense_type<T>) {
+    auto common = std::min(left.dots.extent(), right.dots.extent());
+    res.dots.grow(common);
+    details::simd::active().intersection(res.dots.data(), left.dots.data(),
+                                         right.dots.data(), common);
+  } else if constexpr (ordered_type<T>) {
+    auto comp = left.dots.key_comp();
+    auto l = left.dots.begin();
+    auto r = right.dots.begin();
+    while (l != left.dots.end() && r != right.dots.end()) {
+      if (comp(l->first, r->first)) {
+        ++l;
+      } else if (comp(r->first, l->first)) {
+        ++r;
+      } else {
+        if (l->second == r->second)
+          res.dots.emplace_hint(res.dots.end(), l->first, l->second);
+        ++l, ++r;
+      }
+    }
+  } else {
+    for (const auto &[actor, counter] : left.dots)
+      if (auto it = right.dots.find(actor);
+          it != right.dots.end() && it->second == counter)
+        res.dots.emplace(actor, counter);
+  }
   return res;
 }
 
+/// clock held in the backend of _To, clock itself when it already is.
+template <typename _To, actor_type A,
+          iterable_assiative_type<A, std::uint64_t> T>
+constexpr auto clock_cast(const version_vector<A, T> &clock) -> decltype(auto) {
+  if constexpr (std::same_as<_To, version_vector<A, T>>)
+    return (clock);
+  else
+    return _To(clock);
+}
+
 } // namespace crdt.
 
 namespace std {
@@ -137,11 +384,24 @@ using namespace crdt;
 template <actor_type A, iterable_assiative_type<A, std::uint64_t> T>
 struct hash<version_vector<A, T>> {
   size_t operator()(const version_vector<A, T> &k) const {
-    std::hash<A> elem_hash;
-    return std::accumulate(k.dots.begin(), k.dots.end(), 0,
-                           [&elem_hash](size_t acc, const auto &elem) {
-                             return acc ^ elem_hash(elem.first);
-                           });
+    std::hash<A> actor_hash;
+    std::hash<std::uint64_t> counter_hash;
+    // entries are summed so hashed backends iterating in any order agree,
+    // each one mixing the counter in so clocks of the same actors spread.
+    // The splitmix64 finalizer keeps small actors and counters from
+    // cancelling out in the sum, {1: 4, 2: 1} and {1: 1, 2: 2} say.
+    return std::accumulate(
+        k.dots.begin(), k.dots.end(), size_t{0},
+        [&](size_t acc, const auto &elem) {
+          if (elem.second == 0)
+            return acc;
+          std::uint64_t h = actor_hash(elem.first);
+          h ^= counter_hash(elem.second) + 0x9e3779b97f4a7c15 + (h << 6) +
+               (h >> 2);
+          h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9;
+          h = (h ^ (h >> 27)) * 0x94d049bb133111eb;
+          return acc + static_cast<size_t>(h ^ (h >> 31));
+        });
   }
 };
 
@@ -0,0 +1,80 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <actor_registry.hpp>
+#include <orswot.hpp>
+#include <version_vector.hpp>
+
+#include "version_vector_utility.hpp"
+
+using namespace crdt;
+
+auto main() -> int {
+  using namespace boost::ut;
+
+  "ids are dense and stable"_test = [] {
+    actor_registry<std::string> registry;
+
+    expect(index(registry.intern("A")) == 0_i);
+    expect(index(registry.intern("B")) == 1_i);
+    expect(index(registry.intern("A")) == 0_i);
+    expect(registry.size() == 2_i);
+    expect(registry.actor(actor_id{1}) == "B");
+    expect(!registry.find("C").has_value());
+  };
+
+  "concurrent interning hands out one id per actor"_test = [] {
+    actor_registry<int> registry;
+    std::vector<std::jthread> workers;
+    for (int t = 0; t < 4; ++t)
+      workers.emplace_back([&registry] {
+        for (int actor = 0; actor < 1000; ++actor)
+          registry.intern(actor);
+      });
+    workers.clear();
+
+    expect(registry.size() == 1000_i);
+    for (int actor = 0; actor < 1000; ++actor)
+      expect(registry.actor(*registry.find(actor)) == actor);
+  };
+
+  "orswot runs in id space"_test = [] {
+    actor_registry<std::string> registry;
+    orswot<int, actor_id> a, b;
+
+    a.apply(a.add(a.read().derive_add_context(registry.intern("A")), 1));
+    b.apply(b.add(b.read().derive_add_context(registry.intern("B")), 2));
+    a.merge(b);
+
+    auto clock = registry.externalize(a.clock);
+    expect(clock.get("A") == 1_i && clock.get("B") == 1_i);
+    expect(a.read().value.size() == 2_i);
+  };
+
+  "property based tests"_test = [] {
+    expect(rc::check("round trip through the registry",
+                     [](map<std::string> dots) {
+                       actor_registry<std::string> registry;
+                       auto v = build_vector(std::move(dots));
+
+                       RC_ASSERT(registry.externalize(registry.intern(v)) == v);
+                     }));
+
+    expect(rc::check("merge commutes with interning",
+                     [](map<std::string> dots1, map<std::string> dots2) {
+                       actor_registry<std::string> registry;
+                       auto v1 = build_vector(std::move(dots1));
+                       auto v2 = build_vector(std::move(dots2));
+
+                       auto ids = registry.intern(v1);
+                       ids.merge(registry.intern(v2));
+                       v1.merge(v2);
+
+                       RC_ASSERT(registry.externalize(ids) == v1);
+                     }));
+  };
+}
@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <bounded_counter.hpp>
+#include <crdt_traits.hpp>
+
+using quota = crdt::bounded_counter<std::string>;
+
+static_assert(crdt::crdt<quota>);
+
+auto main() -> int {
+  using namespace boost::ut;
+  using namespace crdt;
+
+  "decrements stay within rights"_test = [] {
+    quota a;
+    a.inc("A", 3);
+    expect(a.rights("A") == 3_i);
+
+    a.dec("A", 2);
+    expect(a.read() == 1_i);
+    expect(a.validate_dec("A", 2).has_value());
+
+    auto refused = a.dec("A", 2);
+    expect(refused == quota{});
+    expect(a.read() == 1_i);
+  };
+
+  "transfers move rights between replicas"_test = [] {
+    quota a, b;
+    b.merge(a.inc("A", 10));
+    expect(b.read() == 10_i);
+    expect(b.validate_dec("B").has_value());
+
+    b.merge(a.transfer("A", "B", 4));
+    expect(a.rights("A") == 6_i);
+    expect(b.rights("B") == 4_i);
+
+    a.merge(b.dec("B", 4));
+    expect(a.read() == 6_i);
+    expect(b.validate_dec("B").has_value());
+    expect(a.transfer("A", "A", 1) == quota{});
+  };
+
+  "ops replicate like deltas"_test = [] {
+    quota a, b;
+    std::vector<quota::Op> ops;
+    ops.push_back(quota::Inc{dot<std::string>("A", 5)});
+    ops.push_back(quota::Transfer{"A", dot<std::string>("B", 2)});
+    ops.push_back(quota::Dec{dot<std::string>("B", 1)});
+    for (const auto &op : ops) {
+      expect(!a.validate_op(op).has_value());
+      a.apply(op);
+    }
+    expect(a.validate_op(quota::Dec{dot<std::string>("B", 3)}).has_value());
+
+    b.merge(a);
+    expect(b == a);
+    expect(b.read() == 4_i);
+    expect(b.rights("A") == 3_i);
+    expect(b.rights("B") == 1_i);
+  };
+
+  "property based tests"_test = [] {
+    expect(rc::check("never drops below zero",
+                     [](std::vector<std::uint8_t> steps) {
+                       quota replicas[2], merged;
+                       std::string actors[] = {"A", "B"};
+                       for (std::size_t i = 0; i < steps.size(); ++i) {
+                         auto r = i % 2;
+                         auto &replica = replicas[r];
+                         auto step = steps[i] % 8;
+                         switch (steps[i] % 3) {
+                         case 0:
+                           merged.merge(replica.inc(actors[r], step));
+                           break;
+                         case 1:
+                           merged.merge(replica.dec(actors[r], step));
+                           break;
+                         default:
+                           merged.merge(
+                               replica.transfer(actors[r], actors[1 - r], step));
+                         }
+                         RC_ASSERT(merged.p.read() >= merged.n.read());
+                         RC_ASSERT(merged.rights("A") + merged.rights("B") ==
+                                   merged.read());
+                       }
+                     }));
+  };
+}
@@ -0,0 +1,104 @@
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <btree_map.hpp>
+
+using namespace crdt;
+
+auto main() -> int {
+  using namespace boost::ut;
+
+  "iterates in key order across leaves"_test = [] {
+    btree_map<int, int> m;
+    for (int i = 1000; i-- > 0;)
+      m[i] = i * 2;
+
+    expect(m.size() == 1000_i);
+    int expected = 0;
+    for (const auto &[key, value] : m) {
+      expect(key == expected);
+      expect(value == 2 * expected);
+      ++expected;
+    }
+    expect(m.find(500)->second == 1000_i);
+    expect(!m.contains(1000));
+  };
+
+  "bounds"_test = [] {
+    btree_map<int, int> m;
+    for (int i = 0; i < 500; i += 5)
+      m[i] = i;
+
+    expect(m.lower_bound(10)->first == 10_i);
+    expect(m.lower_bound(11)->first == 15_i);
+    expect(m.upper_bound(10)->first == 15_i);
+    expect(m.lower_bound(496) == m.end());
+    expect(m.upper_bound(-1) == m.begin());
+  };
+
+  "erase returns the next entry"_test = [] {
+    btree_map<int, int> m;
+    for (int i = 0; i < 300; ++i)
+      m[i] = i;
+
+    for (auto it = m.begin(); it != m.end();)
+      it = it->first % 3 ? m.erase(it) : std::next(it);
+
+    expect(m.size() == 100_i);
+    for (const auto &[key, value] : m)
+      expect(key % 3 == 0_i);
+
+    while (!m.empty())
+      m.erase(m.begin());
+    expect(m.begin() == m.end());
+  };
+
+  "copies are independent"_test = [] {
+    btree_map<std::string, std::string> m;
+    for (int i = 0; i < 100; ++i)
+      m[std::to_string(i)] = "x";
+    auto copy = m;
+    m["0"] = "y";
+    m.erase("1");
+
+    expect(copy.size() == 100_i);
+    expect(copy.find("0")->second == "x");
+    expect(copy.contains("1"));
+    expect(m != copy);
+  };
+
+  "property based tests"_test = [] {
+    expect(rc::check("behaves like std::map",
+                     [](const std::vector<std::pair<int, int>> &writes,
+                        const std::vector<int> &erasures, int bound) {
+                       btree_map<int, int> m;
+                       std::map<int, int> expected;
+                       for (const auto &[key, value] : writes) {
+                         m[key] = value;
+                         expected[key] = value;
+                       }
+                       for (auto key : erasures)
+                         RC_ASSERT(m.erase(key) == expected.erase(key));
+
+                       std::vector<std::pair<int, int>> entries(m.begin(),
+                                                                m.end());
+                       std::vector<std::pair<int, int>> sorted(
+                           expected.begin(), expected.end());
+                       RC_ASSERT(m.size() == expected.size());
+                       RC_ASSERT(entries == sorted);
+
+                       auto it = m.lower_bound(bound);
+                       auto expected_it = expected.lower_bound(bound);
+                       RC_ASSERT((it == m.end()) ==
+                                 (expected_it == expected.end()));
+                       if (it != m.end())
+                         RC_ASSERT(it->first == expected_it->first);
+                     }));
+  };
+}
@@ -0,0 +1,86 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <concurrent_orswot.hpp>
+#include <orswot.hpp>
+
+using replicated_set = crdt::orswot<int, std::string>;
+using shared_set = crdt::concurrent_orswot<int, std::string, 8>;
+
+auto main() -> int {
+  using namespace boost::ut;
+  using namespace crdt;
+
+  "concurrent writers converge with their replicated ops"_test = [] {
+    shared_set set("A");
+    std::vector<std::vector<replicated_set::Op>> ops(4);
+    {
+      std::vector<std::jthread> writers;
+      for (int w = 0; w < 4; ++w) {
+        writers.emplace_back([&set, &ops, w] {
+          for (int i = 0; i < 1000; ++i) {
+            ops[w].push_back(set.add(w * 1000 + i));
+            if (i % 3 == 0)
+              ops[w].push_back(set.rm(w * 1000 + i));
+          }
+        });
+      }
+    }
+
+    auto snapshot = set.snapshot();
+    expect(snapshot.entries.size() == 2664_i);
+    expect(snapshot.clock.get("A") == 4000_i);
+    expect(set.contains(1) && !set.contains(0));
+
+    replicated_set replica;
+    for (const auto &writer : ops)
+      for (const auto &op : writer)
+        replica.apply(op);
+    expect(replica == snapshot);
+    expect(replica.clock == snapshot.clock);
+  };
+
+  "merge brings in remote adds and removals"_test = [] {
+    shared_set set("A");
+    set.add(1);
+    set.add(2);
+
+    replicated_set remote;
+    remote.merge(set.snapshot());
+    remote.add("B", 3);
+    remote.rm("B", 1);
+
+    set.merge(remote);
+    expect(!set.contains(1));
+    expect(set.contains(2) && set.contains(3));
+
+    set.add(4);
+    remote.merge(set.snapshot());
+    expect(remote == set.snapshot());
+    expect(remote.clock.get("A") == 3_i);
+  };
+
+  "property based tests"_test = [] {
+    expect(rc::check("snapshot matches a plain orswot",
+                     [](std::vector<int> added, std::vector<int> removed) {
+                       shared_set set("A");
+                       replicated_set plain;
+                       for (auto member : added) {
+                         set.add(member);
+                         plain.add("A", member);
+                       }
+                       for (auto member : removed) {
+                         set.rm(member);
+                         plain.rm("A", member);
+                       }
+
+                       auto snapshot = set.snapshot();
+                       RC_ASSERT(snapshot == plain);
+                       RC_ASSERT(snapshot.clock == plain.clock);
+                     }));
+  };
+}
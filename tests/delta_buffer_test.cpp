@@ -0,0 +1,95 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <delta_buffer.hpp>
+#include <orswot.hpp>
+
+using replicated_set = crdt::orswot<std::string, std::string>;
+using buffer = crdt::delta_buffer<replicated_set, std::string>;
+
+auto main() -> int {
+  using namespace boost::ut;
+  using namespace crdt;
+
+  "add delta holds only the new member"_test = [] {
+    replicated_set a;
+    a.add("A", "x");
+    auto delta = a.add("A", "y");
+
+    expect(delta.entries.size() == 1_i);
+    expect(delta.entries.contains("y"));
+    expect(delta.deferred.empty());
+  };
+
+  "remove of an absent member is an empty delta"_test = [] {
+    replicated_set a;
+    a.add("A", "x");
+    auto delta = a.rm("A", "y");
+
+    expect(delta.entries.empty());
+    expect(delta.deferred.empty());
+    expect(delta.cloud.empty());
+  };
+
+  "peers catch up from the interval since their ack"_test = [] {
+    replicated_set a, b;
+    buffer deltas;
+
+    deltas.push(a.add("A", "x"));
+    b.merge(*deltas.interval(0));
+    deltas.ack("B", deltas.seq());
+    expect(deltas.empty());
+
+    deltas.push(a.add("A", "y"));
+    deltas.push(a.rm("A", "x"));
+    deltas.push(a.add("A", "z"));
+
+    auto interval = deltas.interval(1);
+    expect(interval.has_value());
+    b.merge(*interval);
+    expect(b == a);
+    expect(b.clock == a.clock);
+  };
+
+  "dropped deltas force a full state sync"_test = [] {
+    replicated_set a;
+    buffer deltas;
+
+    deltas.push(a.add("A", "x"));
+    deltas.push(a.add("A", "y"));
+    deltas.ack("C", 1);
+    deltas.ack("B", 2);
+    expect(deltas.first_seq() == 1_i);
+    expect(!deltas.interval(0).has_value());
+
+    deltas.forget("C");
+    expect(deltas.first_seq() == 2_i);
+    expect(deltas.interval(2).has_value());
+  };
+
+  "property based tests"_test = [] {
+    expect(rc::check("interval converges like full state",
+                     [](std::vector<std::string> added,
+                        std::vector<bool> removed, std::size_t acked) {
+                       replicated_set origin, replica;
+                       buffer deltas;
+                       for (std::size_t i = 0; i < added.size(); ++i) {
+                         deltas.push(origin.add("A", added[i]));
+                         if (i < removed.size() && removed[i])
+                           deltas.push(origin.rm("A", added[i]));
+                       }
+
+                       acked %= deltas.seq() + 1;
+                       replica.merge(*deltas.interval(0));
+                       auto full(replica);
+                       replica.merge(*deltas.interval(acked));
+
+                       RC_ASSERT(replica == origin);
+                       RC_ASSERT(full == origin);
+                     }));
+  };
+}
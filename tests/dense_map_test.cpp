@@ -0,0 +1,135 @@
+#include <compare>
+#include <cstdint>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <dense_map.hpp>
+#include <simd.hpp>
+#include <version_vector.hpp>
+
+#include "version_vector_utility.hpp"
+
+using namespace crdt;
+
+using dense_vector = dense_version_vector<std::uint8_t>;
+
+auto kernel_sets() -> std::vector<const details::simd::kernels *> {
+  std::vector<const details::simd::kernels *> sets{
+      &details::simd::scalar_kernels};
+#ifdef CRDT_SIMD_X86
+  if (__builtin_cpu_supports("sse4.2"))
+    sets.push_back(&details::simd::sse_kernels);
+  if (__builtin_cpu_supports("avx2"))
+    sets.push_back(&details::simd::avx2_kernels);
+#endif
+  return sets;
+}
+
+auto main() -> int {
+  using namespace boost::ut;
+
+  "iteration skips absent actors"_test = [] {
+    dense_map<actor_id> m;
+    m[actor_id{3}] = 7;
+    m[actor_id{1}] = 2;
+
+    expect(m.size() == 2_i);
+    expect(m.extent() == 4_i);
+    expect(m.begin()->first == actor_id{1});
+    expect(!m.contains(actor_id{0}) && !m.contains(actor_id{9}));
+
+    m.erase(m.find(actor_id{1}));
+    expect(m.size() == 1_i);
+    expect(m.begin()->second == 7_i);
+  };
+
+  "counters above the sign bit compare unsigned"_test = [] {
+    for (const auto *k : kernel_sets()) {
+      std::vector<std::uint64_t> a(9, 1ull << 63), b(9, 1);
+      expect(k->dominates(a.data(), b.data(), a.size()));
+      expect(!k->dominates(b.data(), a.data(), a.size()));
+      k->merge(b.data(), a.data(), b.size());
+      expect(b == a);
+    }
+  };
+
+  "property based tests"_test = [] {
+    expect(rc::check("kernels agree with the scalar ones",
+                     [](std::vector<std::uint8_t> a,
+                        std::vector<std::uint8_t> b) {
+                       auto n = std::min(a.size(), b.size());
+                       std::vector<std::uint64_t> x(a.begin(), a.begin() + n);
+                       std::vector<std::uint64_t> y(b.begin(), b.begin() + n);
+                       const auto &scalar = details::simd::scalar_kernels;
+
+                       for (const auto *k : kernel_sets()) {
+                         auto ord = k->compare(x.data(), y.data(), n);
+                         auto expected = scalar.compare(x.data(), y.data(), n);
+                         RC_ASSERT(ord.greater == expected.greater);
+                         RC_ASSERT(ord.less == expected.less);
+                         RC_ASSERT(k->dominates(x.data(), y.data(), n) ==
+                                   scalar.dominates(x.data(), y.data(), n));
+
+                         std::vector<std::uint64_t> got(n), want(n);
+                         k->intersection(got.data(), x.data(), y.data(), n);
+                         scalar.intersection(want.data(), x.data(), y.data(), n);
+                         RC_ASSERT(got == want);
+
+                         got = x, want = x;
+                         k->merge(got.data(), y.data(), n);
+                         scalar.merge(want.data(), y.data(), n);
+                         RC_ASSERT(got == want);
+
+                         got = x, want = x;
+                         k->reset_remove(got.data(), y.data(), n);
+                         scalar.reset_remove(want.data(), y.data(), n);
+                         RC_ASSERT(got == want);
+                       }
+                     }));
+
+    expect(rc::check("merge matches the hash map backend",
+                     [](map<std::uint8_t> dots1, map<std::uint8_t> dots2) {
+                       auto dense = build<dense_vector>(dots1);
+                       auto v = build_vector(std::move(dots1));
+
+                       dense.merge(build<dense_vector>(dots2));
+                       v.merge(build_vector(std::move(dots2)));
+
+                       RC_ASSERT(same_dots(dense, v));
+                     }));
+
+    expect(rc::check("reset_remove matches the hash map backend",
+                     [](map<std::uint8_t> dots1, map<std::uint8_t> dots2) {
+                       auto dense = build<dense_vector>(dots1);
+                       auto v = build_vector(std::move(dots1));
+
+                       dense.reset_remove(build<dense_vector>(dots2));
+                       v.reset_remove(build_vector(std::move(dots2)));
+
+                       RC_ASSERT(same_dots(dense, v));
+                     }));
+
+    expect(rc::check("intersection matches the hash map backend",
+                     [](map<std::uint8_t> dots1, map<std::uint8_t> dots2) {
+                       auto dense = intersection(build<dense_vector>(dots1),
+                                                 build<dense_vector>(dots2));
+                       auto v = intersection(build_vector(std::move(dots1)),
+                                             build_vector(std::move(dots2)));
+
+                       RC_ASSERT(same_dots(dense, v));
+                     }));
+
+    expect(rc::check("comparison matches the hash map backend",
+                     [](map<std::uint8_t> dots1, map<std::uint8_t> dots2) {
+                       auto d1 = build<dense_vector>(dots1);
+                       auto d2 = build<dense_vector>(dots2);
+                       auto v1 = build_vector(std::move(dots1));
+                       auto v2 = build_vector(std::move(dots2));
+
+                       RC_ASSERT((d1 <=> d2) == (v1 <=> v2));
+                       RC_ASSERT(d1.dominates(d2) == v1.dominates(v2));
+                     }));
+  };
+}
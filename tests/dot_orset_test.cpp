@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <dot_orset.hpp>
+#include <orswot.hpp>
+#include <version_vector.hpp>
+
+using set = std::unordered_set<std::string>;
+using replicated_set = crdt::dot_orset<std::string, std::string>;
+
+void setup_set(std::string &&ctx, replicated_set &crdt_set, set s) {
+  for (auto &&v : s) {
+    crdt_set.apply(crdt_set.add(crdt_set.read().derive_add_context(ctx), v));
+  }
+}
+
+auto main() -> int {
+  using namespace boost::ut;
+  using namespace crdt;
+
+  "members keep one dot per actor"_test = [] {
+    replicated_set a;
+    a.add("A", "x");
+    a.add("A", "x");
+    a.add("B", "x");
+
+    expect(a.entries.find("x")->second.size() == 2_i);
+    const auto &dots = a.index[crdt::index(a.actor_ids.at("A"))].dots;
+    expect(dots.size() == 1_i);
+    expect(dots.front().first == 2_i);
+    expect(dots.front().second == &a.entries.find("x")->first);
+  };
+
+  "merge drops the dots the other side removed"_test = [] {
+    replicated_set a, b;
+    a.add("A", "x");
+    a.add("A", "y");
+    b.merge(a);
+    b.rm("B", "x");
+
+    a.merge(b);
+    expect(a.read().value == set{"y"});
+    const auto &dots = a.index[crdt::index(a.actor_ids.at("A"))].dots;
+    expect(std::ranges::none_of(dots, [](const auto &slot) {
+      return slot.first == 1 && slot.second != nullptr;
+    }));
+  };
+
+  "copies index their own entries"_test = [] {
+    replicated_set a;
+    a.add("A", "x");
+    a.add("B", "y");
+    a.rm("A", "x");
+    a.add("A", "z");
+
+    replicated_set b(a);
+    for (const auto &[dots, cleared] : b.index) {
+      expect(cleared == 0_i);
+      for (const auto &[counter, member] : dots)
+        expect(member == &b.entries.find(*member)->first);
+    }
+
+    a.rm("A", "z");
+    b.merge(a);
+    expect(b.read().value == set{"y"});
+  };
+
+  "concurrent add wins over remove"_test = [] {
+    replicated_set a, b;
+    a.add("A", "x");
+    b.merge(a);
+
+    b.rm("B", "x");
+    a.add("A", "x");
+
+    a.merge(b);
+    b.merge(a);
+    expect(a.read().value == set{"x"});
+    expect(b.read().value == set{"x"});
+  };
+
+  "removes ahead of the clock are deferred"_test = [] {
+    replicated_set a, b;
+    std::vector<replicated_set::Op> ops;
+    ops.push_back(a.add(a.read().derive_add_context("A"), "x"));
+    a.apply(ops.back());
+    ops.push_back(a.rm(a.contains("x").derive_remove_context(), "x"));
+    a.apply(ops.back());
+
+    b.apply(ops[1]);
+    expect(b.deferred.size() == 1_i);
+    b.apply(ops[0]);
+    expect(b.read().value.empty());
+    expect(b.deferred.empty());
+  };
+
+  "property based tests"_test = [] {
+    using rc::check;
+
+    expect(check("associative", [](set s1, set s2, set s3) {
+      replicated_set set1;
+      replicated_set set2;
+      replicated_set set3;
+      setup_set("A", set1, s1);
+      setup_set("B", set2, s2);
+      setup_set("C", set3, s3);
+
+      auto set1_snapshot(set1);
+
+      set1.merge(set2);
+      set1.merge(set3);
+
+      set2.merge(set3);
+      set1_snapshot.merge(set2);
+
+      RC_ASSERT(set1 == set1_snapshot);
+    }));
+
+    expect(check("commutative", [](set s1, set s2) {
+      replicated_set set1;
+      replicated_set set2;
+      setup_set("A", set1, s1);
+      setup_set("B", set2, s2);
+
+      auto set1_snapshot(set1);
+
+      set1.merge(set2);
+
+      set2.merge(set1_snapshot);
+
+      RC_ASSERT(set1 == set2);
+    }));
+
+    expect(check("idempotent", [](set s) {
+      replicated_set set;
+      replicated_set set_snapshot;
+      setup_set("A", set, s);
+      setup_set("A", set_snapshot, s);
+
+      set.merge(set_snapshot);
+
+      RC_ASSERT(set == set_snapshot);
+    }));
+
+    expect(check("matches orswot", [](set s1, set s2, set removed) {
+      replicated_set a, b;
+      orswot<std::string, std::string> expected_a, expected_b;
+      for (const auto &v : s1) {
+        a.add("A", v);
+        expected_a.add("A", v);
+      }
+      b.merge(a);
+      expected_b.merge(expected_a);
+      for (const auto &v : s2) {
+        b.add("B", v);
+        expected_b.add("B", v);
+      }
+      for (const auto &v : removed) {
+        a.rm("A", v);
+        expected_a.rm("A", v);
+      }
+
+      a.merge(b);
+      expected_a.merge(expected_b);
+
+      RC_ASSERT(a.read().value == expected_a.read().value);
+      RC_ASSERT(a.clock == expected_a.clock);
+    }));
+  };
+}
@@ -0,0 +1,119 @@
+#include <compare>
+#include <string>
+#include <unordered_map>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <flat_map.hpp>
+#include <version_vector.hpp>
+
+#include "version_vector_utility.hpp"
+
+using namespace crdt;
+
+template <actor_type A> using flat = flat_map<A, std::uint64_t, 4>;
+template <actor_type A> using flat_vector = version_vector<A, flat<A>>;
+
+template <actor_type A>
+auto expected_order(const map<A> &left, const map<A> &right)
+    -> std::partial_ordering {
+  auto get = [](const map<A> &m, const A &a) -> std::uint64_t {
+    auto it = m.find(a);
+    return it == m.end() ? 0 : it->second;
+  };
+  bool greater = false, less = false;
+  for (const auto &[actor, counter] : left)
+    greater |= counter > get(right, actor);
+  for (const auto &[actor, counter] : right)
+    less |= counter > get(left, actor);
+
+  if (greater && less)
+    return std::partial_ordering::unordered;
+  if (greater)
+    return std::partial_ordering::greater;
+  if (less)
+    return std::partial_ordering::less;
+  return std::partial_ordering::equivalent;
+}
+
+auto main() -> int {
+  using namespace boost::ut;
+
+  "keeps entries sorted"_test = [] {
+    flat_map<std::string, std::uint64_t, 2> m;
+    m["c"] = 3;
+    m["a"] = 1;
+    m["b"] = 2;
+    m["d"] = 4;
+
+    expect(m.size() == 4_i);
+    expect(std::is_sorted(m.begin(), m.end()));
+    expect(m.find("b")->second == 2_i);
+    expect(!m.contains("e"));
+
+    m.erase(m.find("a"));
+    expect(m.begin()->first == "b");
+    expect(m.size() == 3_i);
+  };
+
+  "merge into a clock with the same actors stays inline"_test = [] {
+    flat_vector<int> a, b;
+    for (int actor = 0; actor < 4; ++actor) {
+      a.dots[actor] = actor;
+      b.dots[actor] = 4 - actor;
+    }
+    auto *storage = a.dots.begin();
+
+    a.merge(b);
+
+    expect(a.dots.begin() == storage);
+    expect(a.get(0) == 4_i && a.get(3) == 3_i);
+  };
+
+  assert(rc::check("merge matches the hash map backend",
+                   [](map<std::string> dots1, map<std::string> dots2) {
+                     auto flat1 = build<flat_vector<std::string>>(dots1);
+                     auto v1 = build_vector(std::move(dots1));
+                     auto v2 = build_vector(map<std::string>(dots2));
+
+                     flat1.merge(build<flat_vector<std::string>>(dots2));
+                     v1.merge(v2);
+
+                     RC_ASSERT(same_dots(flat1, v1));
+                   }));
+
+  assert(rc::check("reset_remove matches the hash map backend",
+                   [](map<int> dots1, map<int> dots2) {
+                     auto flat1 = build<flat_vector<int>>(dots1);
+                     auto v1 = build_vector(std::move(dots1));
+                     auto v2 = build_vector(map<int>(dots2));
+
+                     flat1.reset_remove(build<flat_vector<int>>(dots2));
+                     v1.reset_remove(v2);
+
+                     RC_ASSERT(same_dots(flat1, v1));
+                   }));
+
+  assert(rc::check("intersection matches the hash map backend",
+                   [](map<int> dots1, map<int> dots2) {
+                     auto flat_common =
+                         intersection(build<flat_vector<int>>(dots1),
+                                      build<flat_vector<int>>(dots2));
+                     auto common = intersection(build_vector(map<int>(dots1)),
+                                                build_vector(map<int>(dots2)));
+
+                     RC_ASSERT(same_dots(flat_common, common));
+                   }));
+
+  assert(rc::check("comparison is the pointwise partial order",
+                   [](map<int> dots1, map<int> dots2) {
+                     auto flat1 = build<flat_vector<int>>(dots1);
+                     auto flat2 = build<flat_vector<int>>(dots2);
+
+                     RC_ASSERT((flat1 <=> flat2) ==
+                               expected_order(dots1, dots2));
+                     RC_ASSERT((flat1 <=> flat1) ==
+                               std::partial_ordering::equivalent);
+                   }));
+}
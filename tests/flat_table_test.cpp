@@ -0,0 +1,173 @@
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <flat_table.hpp>
+#include <orswot.hpp>
+#include <version_vector.hpp>
+
+using namespace crdt;
+
+/// Gives keys only two hashes, so lookups walk the probe sequence.
+struct colliding_hash {
+  auto operator()(int key) const noexcept -> std::size_t {
+    return static_cast<std::size_t>(key % 2);
+  }
+};
+
+struct string_hash : std::hash<std::string_view> {
+  using is_transparent = void;
+};
+
+using set = std::unordered_set<std::string>;
+using flat_set = orswot<std::string, std::string,
+                        flat_table<std::string, inline_clock<std::string>>>;
+
+auto main() -> int {
+  using namespace boost::ut;
+
+  "finds inserted and erased keys"_test = [] {
+    flat_table<int, int> m;
+    for (int i = 0; i < 1000; ++i)
+      m[i] = i * 2;
+
+    expect(m.size() == 1000_i);
+    expect(m.find(42)->second == 84_i);
+    expect(!m.contains(1000));
+
+    expect(m.erase(42) == 1_i);
+    expect(m.erase(42) == 0_i);
+    expect(!m.contains(42));
+    expect(m.size() == 999_i);
+  };
+
+  "erase returns the next entry"_test = [] {
+    flat_table<int, int> m;
+    for (int i = 0; i < 200; ++i)
+      m[i] = i;
+
+    for (auto it = m.begin(); it != m.end();)
+      it = it->first % 2 ? m.erase(it) : std::next(it);
+
+    expect(m.size() == 100_i);
+    for (const auto &[key, value] : m)
+      expect(key % 2 == 0_i);
+  };
+
+  "sequential keys"_test = [] {
+    // std::hash<int> is the identity: keys only spread once it is mixed.
+    flat_table<int, int> m;
+    for (int i = 0; i < 1 << 16; ++i)
+      m[i] = i;
+    for (int i = 0; i < 1 << 16; i += 2)
+      m.erase(i);
+
+    expect(m.size() == 32768_i);
+    expect(!m.contains(1024));
+    expect(m.find(1025)->second == 1025_i);
+  };
+
+    "colliding hashes"_test = [] {
+    flat_table<int, int, colliding_hash> m;
+    for (int i = 0; i < 100; ++i)
+      m[i] = i;
+    for (int i = 0; i < 100; i += 3)
+      m.erase(i);
+
+    expect(m.size() == 66_i);
+    expect(!m.contains(3));
+    expect(m.find(4)->second == 4_i);
+  };
+
+  "copies are independent"_test = [] {
+    flat_table<std::string, std::string> m;
+    m["a"] = "1";
+    auto copy = m;
+    m["a"] = "2";
+    m["b"] = "3";
+
+    expect(copy.size() == 1_i);
+    expect(copy.find("a")->second == "1");
+    expect(m != copy);
+  };
+
+  "transparent lookup"_test = [] {
+    flat_table<std::string, int, string_hash, std::equal_to<>> m;
+    m["key"] = 1;
+    expect(m.contains(std::string_view("key")));
+    expect(m.find(std::string_view("key"))->second == 1_i);
+  };
+
+  "orswot members keep inline clocks"_test = [] {
+    flat_set a, b, c;
+    a.add("A", "x");
+    b.add("B", "x");
+    c.add("C", "x");
+    a.merge(b);
+    a.merge(c);
+
+    const auto &vclock = a.entries.find("x")->second;
+    expect(vclock.dots.size() == 3_i);
+    expect(vclock.get("C") == 1_i);
+    expect(a.contains("x").remove_vector ==
+           version_vector<std::string>(vclock));
+
+    a.merge(a.rm("A", "x"));
+    expect(!a.contains("x").value);
+    b.merge(a);
+    expect(!b.contains("x").value);
+  };
+
+  "property based tests"_test = [] {
+    expect(rc::check("behaves like std::map",
+                     [](const std::vector<std::pair<int, int>> &writes,
+                        const std::vector<int> &erasures) {
+                       flat_table<int, int> m;
+                       std::map<int, int> expected;
+                       for (const auto &[key, value] : writes) {
+                         m[key] = value;
+                         expected[key] = value;
+                       }
+                       for (auto key : erasures)
+                         RC_ASSERT(m.erase(key) == expected.erase(key));
+
+                       std::map<int, int> entries(m.begin(), m.end());
+                       RC_ASSERT(m.size() == expected.size());
+                       RC_ASSERT(entries == expected);
+                     }));
+
+    expect(rc::check("orswot entries", [](set s1, set s2, set removed) {
+      flat_set a, b;
+      orswot<std::string, std::string> expected_a, expected_b;
+      for (const auto &v : s1) {
+        a.add("A", v);
+        expected_a.add("A", v);
+      }
+      for (const auto &v : s2) {
+        b.add("B", v);
+        expected_b.add("B", v);
+      }
+      b.merge(a);
+      expected_b.merge(expected_a);
+      for (const auto &v : removed) {
+        b.rm("B", v);
+        expected_b.rm("B", v);
+      }
+      a.merge(b);
+      expected_a.merge(expected_b);
+
+      RC_ASSERT(a.read().value == expected_a.read().value);
+      for (const auto &[member, vclock] : expected_a.entries)
+        RC_ASSERT(a.entries.find(member)->second ==
+                  inline_clock<std::string>(vclock));
+    }));
+  };
+}
@@ -44,6 +44,25 @@ auto main() -> int {
     expect(A.read() == (B.read() + steps));
   };
 
+  "totals follow merges and removals"_test = [] {
+    gcounter<std::string> A;
+    gcounter<std::string> B;
+
+    A.inc("A", 4'000'000'000u);
+    B.inc("B", 4'000'000'000u);
+    A.merge(B);
+    expect(A.read() == 8'000'000'000_ull);
+
+    B.inc("A", 1);
+    A.merge(B);
+    expect(A.read() == 8'000'000'000_ull);
+
+    version_vector<std::string> removed;
+    removed.apply(dot<std::string>("B", 4'000'000'000u));
+    A.reset_remove(removed);
+    expect(A.read() == 4'000'000'000_ull);
+  };
+
   assert(rc::check("associative",
                    [](map<int> dots1, map<int> dots2, map<int> dots3) {
                      auto counter1 = gcounter(build_vector(std::move(dots1)));
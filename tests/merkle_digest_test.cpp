@@ -0,0 +1,168 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <merkle_digest.hpp>
+#include <mvreg.hpp>
+#include <ormwot.hpp>
+#include <orswot.hpp>
+
+using set = std::unordered_set<std::string>;
+using replicated_set = crdt::orswot<std::string, std::string>;
+using replicated_map = crdt::ormwot<int, crdt::mvreg<int, std::uint64_t>>;
+
+auto main() -> int {
+  using namespace boost::ut;
+  using namespace crdt;
+
+  "digest does not depend on insertion order"_test = [] {
+    merkle_digest a, b;
+    for (std::size_t i = 0; i < 100; ++i)
+      a.add(i, i * 7);
+    for (std::size_t i = 100; i-- > 0;)
+      b.add(i, i * 7);
+    expect(a == b);
+
+    a.remove(42, 42 * 7);
+    expect(a != b);
+    expect(a.differing(b).size() == 1_i);
+    expect(a.differing(b).front() ==
+           merkle_digest::bucket_of(42, merkle_digest::default_depth));
+  };
+
+  "comparing level by level finds the same buckets"_test = [] {
+    merkle_digest a(2), b(2);
+    for (std::size_t i = 0; i < 50; ++i) {
+      a.add(i, i);
+      b.add(i, i == 3 || i == 30 ? i + 1 : i);
+    }
+
+    std::vector<std::size_t> nodes{0};
+    for (unsigned l = 0; l < a.depth(); ++l)
+      nodes = merkle_digest::children(a.compare(l, nodes, b.hashes(l, nodes)));
+    nodes = a.compare(a.depth(), nodes, b.hashes(a.depth(), nodes));
+    expect(nodes == a.differing(b));
+  };
+
+  "converged replicas extract nothing"_test = [] {
+    replicated_set a, b;
+    for (const auto *member : {"x", "y", "z"})
+      a.add("A", member);
+    b.merge(a);
+
+    auto delta = a.extract(b.digest());
+    expect(delta.buckets.empty());
+    expect(delta.state.entries.empty());
+  };
+
+  "kept digests follow the replica"_test = [] {
+    replicated_set a, b;
+    a.keep_digest();
+    for (const auto *member : {"x", "y", "z"})
+      a.add("A", member);
+    b.add("B", "w");
+    b.merge(a.rm("A", "y"));
+    a.merge(b);
+    a.merge(a.add("A", "y"));
+
+    replicated_set rebuilt;
+    rebuilt.merge(a);
+    expect(a.digest() == rebuilt.digest());
+    expect(a.extract(b.digest()).state.entries.size() == 3_i);
+
+    replicated_map m, n;
+    m.keep_digest(2);
+    m.update(1, 7, [](const auto &ctx, auto &v) { return v.write(ctx, 1); });
+    n.merge(m);
+    n.update(2, 8, [](const auto &ctx, auto &v) { return v.write(ctx, 2); });
+    m.merge(n.rm(2, 7));
+    m.merge(n);
+
+    replicated_map copy;
+    copy.merge(m);
+    expect(m.digest(2) == copy.digest(2));
+    expect(m.extract(n.digest(2)).buckets.empty());
+  };
+
+  "property based tests"_test = [] {
+    using rc::check;
+
+    expect(check("set delta merge matches full merge",
+                 [](set common, set added, set removed) {
+                   replicated_set a, b;
+                   for (const auto &v : common)
+                     a.add("A", v);
+                   b.merge(a);
+                   for (const auto &v : added)
+                     a.add("A", v);
+                   for (const auto &v : removed)
+                     b.rm("B", v);
+
+                   auto full(a);
+                   full.merge(b);
+                   a.merge(b.extract(a.digest()));
+
+                   RC_ASSERT(a == full);
+                   RC_ASSERT(a.clock == full.clock);
+                 }));
+
+    expect(check("map delta merge matches full merge",
+                 [](std::vector<std::pair<int, std::uint64_t>> common,
+                    std::vector<std::pair<int, std::uint64_t>> written) {
+                   replicated_map a, b;
+                   auto write = [](replicated_map &m, int actor,
+                                   const auto &entries) {
+                     for (const auto &[key, val] : entries)
+                       m.update(actor, key, [val](const auto &ctx, auto &v) {
+                         return v.write(ctx, val);
+                       });
+                   };
+                   write(a, 1, common);
+                   b.merge(a);
+                   write(b, 2, written);
+
+                   auto full(a);
+                   full.merge(b);
+                   a.merge(b.extract(a.digest()));
+
+                   RC_ASSERT(a == full);
+                   RC_ASSERT(a.clock == full.clock);
+                 }));
+
+    expect(check("map digest sync matches full merge under removals",
+                 [](std::vector<std::pair<int, std::uint64_t>> common,
+                    std::vector<std::pair<int, std::uint64_t>> written,
+                    std::vector<int> removed) {
+                   replicated_map a, b;
+                   auto write = [](replicated_map &m, int actor,
+                                   const auto &entries) {
+                     for (const auto &[key, val] : entries)
+                       m.update(actor, key, [val](const auto &ctx, auto &v) {
+                         return v.write(ctx, val);
+                       });
+                   };
+                   write(a, 1, common);
+                   b.merge(a);
+                   b.keep_digest();
+                   // a removes keys b concurrently rewrites, leaving values
+                   // whose write dots a's removal took out of the clocks.
+                   for (auto key : removed)
+                     a.rm(1, key);
+                   write(b, 2, written);
+
+                   auto full(a);
+                   full.merge(b);
+                   a.merge(b.extract(a.digest()));
+                   b.merge(a.extract(b.digest()));
+
+                   RC_ASSERT(a == full);
+                   RC_ASSERT(b == full);
+                   RC_ASSERT(b.digest() == full.digest());
+                 }));
+  };
+}
@@ -74,6 +74,59 @@ auto main() -> int {
            std::vector<std::string>{"bob", "alice"});
   };
 
+  "merge keeps concurrent values only"_test = [] {
+    mvreg<std::string, int> a, b, c;
+    a.write("A", 1);
+    b.write("B", 2);
+    c.write("C", 3);
+    a.merge(b);
+    a.merge(std::move(c));
+    expect(a.vals.size() == 3_i);
+
+    auto older = a;
+    a.write("A", 4);
+    a.merge(older);
+    expect(a.read().value == std::vector<int>{4});
+
+    older.merge(a);
+    expect(older == a);
+  };
+
+  "single values stay inline"_test = [] {
+    mvreg<std::string, int> a, b;
+    a.write("A", 1);
+    expect(a.vals.capacity() == 1_i);
+
+    b.write("B", 2);
+    a.merge(b);
+    expect(a.vals.size() == 2_i);
+
+    a.write("A", 3);
+    expect(a.vals.size() == 1_i);
+    expect(a.vals.capacity() == 1_i);
+  };
+
+  "clock follows the values"_test = [] {
+    mvreg<std::string, int> a, b;
+    a.write("A", 1);
+    b.write("B", 2);
+    a.merge(b);
+    expect(a.clock() == mvreg<std::string, int>(a.vals).clock());
+
+    a.reset_remove(b.clock());
+    expect(a.read().value == std::vector<int>{1});
+    expect(a.clock() == mvreg<std::string, int>(a.vals).clock());
+    expect(a.clock().get("B") == 0_i);
+    expect(&a.clock() == &a.vals.front().vclock);
+
+    a.merge(b);
+    expect(a.clock().get("A") == 1_i);
+    expect(a.clock().get("B") == 1_i);
+
+    mvreg<std::string, int> empty;
+    expect(empty.clock() == version_vector<std::string>{});
+  };
+
   "property based tests"_test = [] {
     using rc::check;
 
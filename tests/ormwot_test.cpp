@@ -3,15 +3,22 @@
 #include <functional>
 #include <iostream>
 #include <map>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <boost/ut.hpp>
 #include <rapidcheck.h>
 
+#include <btree_map.hpp>
 #include <crdt_traits.hpp>
+#include <delta_buffer.hpp>
+#include <gcounter.hpp>
 #include <mvreg.hpp>
 #include <ormwot.hpp>
+#include <persistent_map.hpp>
 #include <orswot.hpp>
 
 #include "utility.hpp"
@@ -20,6 +27,15 @@ using val_type = crdt::mvreg<int, std::uint64_t>;
 using entry_type = std::pair<int, std::uint64_t>;
 using entries_type = std::vector<entry_type>;
 using replicated_map = crdt::ormwot<int, val_type>;
+using ordered_map = crdt::ormwot<
+    int, val_type, std::unordered_set<int>,
+    crdt::btree_map<int, crdt::details::map::Entry<int, val_type>>>;
+using tenant_map = crdt::ormwot<
+    std::string, val_type, std::unordered_set<std::string>,
+    crdt::btree_map<std::string,
+                    crdt::details::map::Entry<int, val_type>>>;
+using counter_map = crdt::ormwot<
+    std::string, crdt::ormwot<std::string, crdt::gcounter<std::string>>>;
 
 void setup_map(int actor, replicated_map &m, entries_type entries) {
   for (auto entry : entries) {
@@ -72,6 +88,108 @@ void showValue(const ormwot<K, V> &v, std::ostream &os) {
 auto main() -> int {
   using namespace boost::ut;
 
+  "views read entries in place"_test = [] {
+    replicated_map m;
+    setup_map(1, m, {{1, 10}, {2, 20}});
+
+    std::map<int, std::uint64_t> items;
+    for (const auto &[key, val] : m.items())
+      items[key] = val.read().value.front();
+    expect(items == std::map<int, std::uint64_t>{{1, 10}, {2, 20}});
+
+    for (const auto &[key, vclock] : m.clocks())
+      expect(vclock == m.entries.find(key)->second.clock);
+    expect(m.keys().size() == 2_i);
+    expect(m.values().size() == 2_i);
+
+    auto keys = m.keys();
+    m.apply(m.rm(keys.derive_remove_context(), 1));
+    expect(!m.entries.contains(1));
+  };
+
+  "merges leave untouched persistent entries shared"_test = [] {
+    using persistent_map_type = crdt::ormwot<
+        int, val_type, std::unordered_set<int>,
+        crdt::persistent_map<int, crdt::details::map::Entry<int, val_type>>>;
+    persistent_map_type a, b;
+    for (int key = 0; key < 3; ++key)
+      a.update(1, key, [key](const auto &ctx, auto &v) {
+        return v.write(ctx, std::uint64_t(key));
+      });
+
+    auto snapshot = a.entries.snapshot();
+    a.merge(b);
+    for (int key = 0; key < 3; ++key)
+      expect(&std::as_const(a.entries).find(key)->second ==
+             &std::as_const(snapshot).find(key)->second);
+  };
+
+  "range and prefix views"_test = [] {
+    tenant_map m;
+    for (const auto *key : {"t1/a", "t1/b", "t2/a", "t2/b", "t2/c", "t3"})
+      m.update(1, key, [](const auto &ctx, auto &v) {
+        return v.write(ctx, std::uint64_t{1});
+      });
+
+    std::vector<std::string> keys;
+    for (const auto &[key, val] : m.prefix("t2/"))
+      keys.push_back(key);
+    expect(keys == std::vector<std::string>{"t2/a", "t2/b", "t2/c"});
+
+    keys.clear();
+    for (const auto &[key, val] : m.range("t1/b", "t2/b"))
+      keys.push_back(key);
+    expect(keys == std::vector<std::string>{"t1/b", "t2/a"});
+
+    expect(m.range("t2", "t1").begin() == m.range("t2", "t1").end());
+    expect(m.prefix("t4").begin() == m.prefix("t4").end());
+
+    auto tenant = m.prefix("t1/");
+    m.apply(m.rm(tenant.derive_remove_context(), "t1/a"));
+    expect(!m.entries.contains("t1/a"));
+  };
+
+  "deltas carry only the touched entry"_test = [] {
+    replicated_map m;
+    setup_map(1, m, {{1, 10}, {2, 20}, {3, 30}});
+
+    auto delta = m.update(1, 2, [](const auto &ctx, auto &v) {
+      return v.write(ctx, std::uint64_t{21});
+    });
+    expect(delta.entries.size() == 1_i);
+    expect(delta.entries.contains(2));
+
+    expect(m.rm(1, 4).entries.empty());
+    expect(m.rm(1, 4).clock.dots.empty());
+  };
+
+  "nested mutations produce nested deltas"_test = [] {
+    counter_map a, b, c;
+    crdt::delta_buffer<counter_map, std::string> buffer;
+    auto hit = [&](const std::string &page, const std::string &day) {
+      return a.mutate("A", page, [&](auto &days) {
+        return days.mutate("A", day, [](auto &n) { return n.inc("A"); });
+      });
+    };
+
+    for (const auto *day : {"mon", "mon", "tue"}) {
+      auto delta = hit("index", day);
+      expect(delta.entries.size() == 1_i);
+      expect(delta.entries.find("index")->second.val.entries.size() == 1_i);
+      b.merge(delta);
+      buffer.push(std::move(delta));
+    }
+    buffer.push(a.rm("A", "index"));
+    buffer.push(hit("about", "wed"));
+    c.merge(*buffer.interval(0));
+
+    expect(b.entries.find("index")->second.val.entries.find("mon")->second.val
+               .read() == 2_i);
+    expect(c == a);
+    expect(c.clock == a.clock);
+    expect(!c.entries.contains("index"));
+  };
+
   "property based tests"_test = [] {
     using rc::check;
 
@@ -120,6 +238,89 @@ auto main() -> int {
       RC_ASSERT(m == m_snapshot);
     }));
 
+    expect(check("merge by move matches merge by copy",
+                 [](entries_type e1, entries_type e2) {
+                   replicated_map m1;
+                   replicated_map m2;
+                   setup_map(1, m1, e1);
+                   setup_map(2, m2, e2);
+
+                   auto copied(m1);
+                   copied.merge(m2);
+                   m1.merge(std::move(m2));
+
+                   RC_ASSERT(m1 == copied);
+                   RC_ASSERT(m1.clock == copied.clock);
+                 }));
+
+    expect(check("parallel merge matches sequential merge",
+                 [](entries_type e1, entries_type e2, std::uint8_t shards) {
+                   replicated_map m1;
+                   replicated_map m2;
+                   setup_map(1, m1, e1);
+                   setup_map(2, m2, e2);
+
+                   auto sequential(m1);
+                   sequential.merge(m2);
+                   m1.merge(m2, crdt::parallel_merge{shards % 8 + 1u});
+
+                   RC_ASSERT(m1 == sequential);
+                   RC_ASSERT(m1.clock == sequential.clock);
+                 }));
+
+    expect(check("delivery order does not matter", [](entries_type e) {
+      replicated_map origin, replica;
+      std::vector<replicated_map::Op> ops;
+      for (auto entry : e) {
+        ops.push_back(origin.update(
+            origin.read_ctx().derive_add_context(1), entry.first,
+            [val = entry.second](const auto &ctx, auto &v) {
+              return v.write(ctx, val);
+            }));
+        origin.apply(ops.back());
+      }
+
+      for (auto op = ops.rbegin(); op != ops.rend(); ++op)
+        replica.apply(*op);
+
+      RC_ASSERT(replica == origin);
+      RC_ASSERT(replica.clock == origin.clock);
+      RC_ASSERT(replica.cloud.empty());
+    }));
+
+    expect(check("ordered entries merge like hashed entries",
+                 [](entries_type e1, entries_type e2, std::vector<int> removed) {
+                   replicated_map a, b;
+                   ordered_map ordered_a, ordered_b;
+                   auto write = [](auto &m, int actor, const auto &entries) {
+                     for (const auto &[key, val] : entries)
+                       m.update(actor, key, [val](const auto &ctx, auto &v) {
+                         return v.write(ctx, val);
+                       });
+                   };
+                   write(a, 1, e1);
+                   write(ordered_a, 1, e1);
+                   b.merge(a);
+                   ordered_b.merge(ordered_a);
+                   write(b, 2, e2);
+                   write(ordered_b, 2, e2);
+                   for (auto key : removed) {
+                     a.rm(1, key);
+                     ordered_a.rm(1, key);
+                   }
+
+                   a.merge(b);
+                   ordered_a.merge(ordered_b);
+
+                   std::map<int, std::vector<std::uint64_t>> expected, merged;
+                   for (const auto &[key, val] : a.items())
+                     expected[key] = val.read().value;
+                   for (const auto &[key, val] : ordered_a.items())
+                     merged[key] = val.read().value;
+                   RC_ASSERT(merged == expected);
+                   RC_ASSERT(ordered_a.clock == a.clock);
+                 }));
+
     expect(rc::check("add change delta", [](entries_type e, entry_type entry) {
       replicated_map replica1;
       setup_map(1, replica1, e);
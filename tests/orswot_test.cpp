@@ -1,9 +1,16 @@
 #include <algorithm>
+#include <cstdint>
 #include <boost/ut.hpp>
 #include <rapidcheck.h>
 
 #include <orswot.hpp>
+#include <persistent_map.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 using set = std::unordered_set<std::string>;
 using replicated_set = crdt::orswot<std::string, std::string>;
@@ -65,6 +72,26 @@ auto main() -> int {
     expect(a.read().value.empty());
   };
 
+  "deferred removals are released once the clock covers them"_test = [] {
+    orswot<int, std::string> a;
+
+    version_vector<std::string> vc;
+    vc.apply(dot<std::string>("A", 2));
+    a.apply(a.rm(remove_context<std::string>{vc}, 5));
+    expect(a.deferred.size() == 1_i);
+
+    a.apply(a.add(a.read().derive_add_context("A"), 5));
+    expect(a.read().value.empty());
+    expect(a.deferred.size() == 1_i);
+
+    a.apply(a.add(a.read().derive_add_context("A"), 5));
+    expect(a.read().value.empty());
+    expect(a.deferred.empty());
+
+    a.apply(a.add(a.read().derive_add_context("A"), 5));
+    expect(a.read().value.contains(5));
+  };
+
   "test present but removed"_test = [] {
     orswot<int, std::string> a;
     orswot<int, std::string> b;
@@ -127,6 +154,103 @@ auto main() -> int {
     expect(a.read().value.contains(1));
   };
 
+  "out of order adds are buffered until the gap fills"_test = [] {
+    replicated_set a, b;
+    std::vector<replicated_set::Op> ops;
+    for (const auto *member : {"x", "y", "z"}) {
+      ops.push_back(a.add(a.read().derive_add_context("A"), member));
+      a.apply(ops.back());
+    }
+
+    b.apply(ops[2]);
+    b.apply(ops[1]);
+    expect(b.read().value.size() == 2_i);
+    expect(b.clock.get("A") == 0_i);
+    expect(!b.cloud.empty());
+
+    b.apply(ops[0]);
+    expect(b == a);
+    expect(b.clock == a.clock);
+    expect(b.cloud.empty());
+  };
+
+  "batched ops match one at a time"_test = [] {
+    replicated_set a, b;
+    std::vector<std::string> members{"x", "y", "z"};
+    std::vector<replicated_set::Op> ops;
+
+    ops.push_back(a.add(a.read().derive_add_context("A"), members.begin(),
+                        members.end()));
+    a.apply(ops.back());
+    ops.push_back(a.rm(a.read().derive_remove_context(), members.begin(),
+                       members.begin() + 2));
+    a.apply(ops.back());
+    ops.push_back(a.add(a.read().derive_add_context("A"), "w"));
+    a.apply(ops.back());
+
+    std::vector<replicated_set::Op> reversed;
+    for (auto op = ops.rbegin(); op != ops.rend(); ++op)
+      reversed.push_back(std::move(*op));
+    b.apply(std::span<const replicated_set::Op>(reversed));
+    expect(b == a);
+    expect(b.read().value == set{"z", "w"});
+    expect(b.deferred.empty());
+  };
+
+  "members are read in place"_test = [] {
+    replicated_set a;
+    a.add("A", "x");
+    a.add("A", "y");
+
+    auto members = a.members();
+    expect(set(members.begin(), members.end()) == a.read().value);
+
+    a.apply(a.add(members.derive_add_context("A"), "z"));
+    expect(a.read().value == set{"x", "y", "z"});
+  };
+
+  "lookups neither insert nor need the key type"_test = [] {
+    struct string_hash : std::hash<std::string_view> {
+      using is_transparent = void;
+    };
+    orswot<std::string, std::string,
+           std::unordered_map<std::string, version_vector<std::string>,
+                              string_hash, std::equal_to<>>>
+        a;
+    a.add("A", "x");
+
+    const auto &view = a;
+    expect(!view.lookup(std::string_view("y")));
+    expect(!view.contains("y").value);
+    expect(a.entries.size() == 1_i);
+
+    auto found = view.lookup(std::string_view("x"));
+    expect(!!found);
+    a.apply(a.rm(found.derive_remove_context(), "x"));
+    expect(a.entries.empty());
+  };
+
+  "persistent entries keep snapshots across merges"_test = [] {
+    using persistent_set = orswot<
+        std::string, std::string,
+        persistent_map<std::string, version_vector<std::string>>>;
+    persistent_set a, b;
+    for (const auto *member : {"x", "y", "z"})
+      a.add("A", member);
+    b.merge(a);
+    b.rm("B", "x");
+    b.add("B", "w");
+
+    auto snapshot = a.entries.snapshot();
+    a.merge(b);
+
+    expect(!a.entries.contains("x"));
+    expect(a.entries.contains("w"));
+    expect(snapshot.size() == 3_i);
+    expect(snapshot.contains("x"));
+    expect(!snapshot.contains("w"));
+  };
+
   "property based tests"_test = [] {
     using rc::check;
 
@@ -175,6 +299,67 @@ auto main() -> int {
       RC_ASSERT(set == set_snapshot);
     }));
 
+    expect(check("merge by move matches merge by copy",
+                 [](set s1, set s2, set removed) {
+                   replicated_set set1;
+                   replicated_set set2;
+                   setup_set("A", set1, s1);
+                   setup_set("B", set2, s2);
+                   for (const auto &member : removed)
+                     set2.rm("B", member);
+
+                   auto copied(set1);
+                   copied.merge(set2);
+                   set1.merge(std::move(set2));
+
+                   RC_ASSERT(set1 == copied);
+                   RC_ASSERT(set1.clock == copied.clock);
+                   RC_ASSERT(set1.deferred.size() == copied.deferred.size());
+                 }));
+
+    expect(check("parallel merge matches sequential merge",
+                 [](set s1, set s2, set removed, std::uint8_t shards) {
+                   replicated_set set1;
+                   replicated_set set2;
+                   setup_set("A", set1, s1);
+                   setup_set("B", set2, s2);
+                   set2.merge(set1);
+                   for (const auto &member : removed)
+                     set2.rm("B", member);
+
+                   auto sequential(set1);
+                   sequential.merge(set2);
+                   set1.merge(set2, parallel_merge{shards % 8 + 1u});
+
+                   RC_ASSERT(set1 == sequential);
+                   RC_ASSERT(set1.entries == sequential.entries);
+                   RC_ASSERT(set1.clock == sequential.clock);
+                 }));
+
+    expect(check("delivery order does not matter",
+                 [](std::vector<std::string> added, std::vector<bool> removed) {
+                   replicated_set origin, replica;
+                   std::vector<replicated_set::Op> ops;
+                   for (std::size_t i = 0; i < added.size(); ++i) {
+                     ops.push_back(origin.add(
+                         origin.read().derive_add_context("A"), added[i]));
+                     origin.apply(ops.back());
+                     if (i < removed.size() && removed[i]) {
+                       ops.push_back(origin.rm(
+                           origin.contains(added[i]).derive_remove_context(),
+                           added[i]));
+                       origin.apply(ops.back());
+                     }
+                   }
+
+                   for (auto op = ops.rbegin(); op != ops.rend(); ++op)
+                     replica.apply(*op);
+
+                   RC_ASSERT(replica == origin);
+                   RC_ASSERT(replica.clock == origin.clock);
+                   RC_ASSERT(replica.cloud.empty());
+                 }));
+
     expect(rc::check("add change delta", [](set r, std::string value) {
       replicated_set replica1;
       setup_set("A", replica1, r);
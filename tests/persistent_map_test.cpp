@@ -0,0 +1,128 @@
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <persistent_map.hpp>
+
+using namespace crdt;
+
+/// Every key in the same slot at every depth, so all of them end up in one
+/// collision node.
+struct colliding_hash {
+  auto operator()(int key) const noexcept -> std::size_t { return key % 2; }
+};
+
+template <typename Map> auto to_map(const Map &m) -> std::map<int, int> {
+  return {m.begin(), m.end()};
+}
+
+auto main() -> int {
+  using namespace boost::ut;
+
+  "finds inserted and erased keys"_test = [] {
+    persistent_map<int, int> m;
+    for (int i = 0; i < 1000; ++i)
+      m[i] = i * 2;
+
+    expect(m.size() == 1000_i);
+    expect(m.find(42)->second == 84_i);
+    expect(!m.contains(1000));
+
+    expect(m.erase(42) == 1_i);
+    expect(m.erase(42) == 0_i);
+    expect(!m.contains(42));
+    expect(m.size() == 999_i);
+  };
+
+  "snapshots are not affected by later writes"_test = [] {
+    persistent_map<std::string, int> m;
+    m["a"] = 1;
+    m["b"] = 2;
+
+    auto snapshot = m.snapshot();
+    m["a"] = 10;
+    m.erase("b");
+    m["c"] = 3;
+
+    expect(snapshot.size() == 2_i);
+    expect(snapshot.find("a")->second == 1_i);
+    expect(snapshot.contains("b"));
+    expect(!snapshot.contains("c"));
+    expect(m.find("a")->second == 10_i);
+  };
+
+  "writing through an iterator leaves snapshots alone"_test = [] {
+    persistent_map<int, int> m;
+    for (int i = 0; i < 100; ++i)
+      m[i] = i;
+
+    auto snapshot = m.snapshot();
+    for (auto &[key, value] : m)
+      ++value;
+
+    for (const auto &[key, value] : snapshot)
+      expect(value == key);
+    for (const auto &[key, value] : std::as_const(m))
+      expect(value == key + 1);
+  };
+
+  "erase returns the next entry"_test = [] {
+    persistent_map<int, int> m;
+    for (int i = 0; i < 200; ++i)
+      m[i] = i;
+
+    for (auto it = m.begin(); it != m.end();)
+      it = it->first % 2 ? m.erase(it) : std::next(it);
+
+    expect(m.size() == 100_i);
+    for (const auto &[key, value] : std::as_const(m))
+      expect(key % 2 == 0_i);
+  };
+
+  "colliding hashes"_test = [] {
+    persistent_map<int, int, colliding_hash> m;
+    for (int i = 0; i < 50; ++i)
+      m[i] = i;
+    auto snapshot = m.snapshot();
+    for (int i = 0; i < 50; i += 3)
+      m.erase(i);
+
+    expect(snapshot.size() == 50_i);
+    expect(m.size() == 33_i);
+    expect(!m.contains(3));
+    expect(m.find(4)->second == 4_i);
+  };
+
+  "property based tests"_test = [] {
+    expect(rc::check("behaves like std::map",
+                     [](const std::vector<std::pair<int, int>> &writes,
+                        const std::vector<int> &erasures) {
+                       persistent_map<int, int> m;
+                       std::map<int, int> expected;
+                       std::vector<std::pair<persistent_map<int, int>,
+                                             std::map<int, int>>>
+                           snapshots;
+
+                       for (const auto &[key, value] : writes) {
+                         m[key] = value;
+                         expected[key] = value;
+                         snapshots.emplace_back(m.snapshot(), expected);
+                       }
+                       for (auto key : erasures) {
+                         RC_ASSERT(m.erase(key) == expected.erase(key));
+                         snapshots.emplace_back(m.snapshot(), expected);
+                       }
+
+                       RC_ASSERT(m.size() == expected.size());
+                       RC_ASSERT(to_map(m) == expected);
+                       for (const auto &[snapshot, state] : snapshots)
+                         RC_ASSERT(to_map(snapshot) == state);
+                     }));
+  };
+}
@@ -47,6 +47,15 @@ auto main() -> int {
     expect(a.read() == (steps + 1));
   };
 
+  "reads below zero"_test = [] {
+    pncounter<std::string> a;
+    a.dec("A", 3);
+    expect(a.read() == -3_ll);
+
+    a.inc("B", 1);
+    expect(a.read() == -2_ll);
+  };
+
   assert(rc::check("associative", [](std::array<map<int>, 6> dots) {
     pncounter<int> pnc1;
     pnc1.p = gcounter(build_vector(std::move(dots[0])));
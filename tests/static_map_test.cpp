@@ -0,0 +1,148 @@
+#include <compare>
+#include <cstdint>
+#include <string>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <gcounter.hpp>
+#include <mvreg.hpp>
+#include <orswot.hpp>
+#include <pncounter.hpp>
+#include <static_map.hpp>
+#include <version_vector.hpp>
+
+#include "version_vector_utility.hpp"
+
+using namespace crdt;
+
+constexpr std::size_t replicas = 4;
+
+using static_vector = static_version_vector<replicas>;
+
+using hashed_vector = version_vector<std::uint8_t>;
+
+/// counter with its actors folded onto the replica set, so that it builds
+/// the same clock in the static and hash map backends.
+auto fold(const map<std::uint8_t> &counter) -> map<std::uint8_t> {
+  map<std::uint8_t> folded;
+  for (const auto &[actor, value] : counter)
+    folded[actor % replicas] = value;
+  return folded;
+}
+
+constexpr auto merged_clock() {
+  static_vector a, b;
+  a.apply(dot(replica<replicas>(0), 3));
+  b.apply(dot(replica<replicas>(1), 2));
+  a.merge(b);
+  return a;
+}
+
+static_assert(merged_clock().get(replica<replicas>(0)) == 3);
+static_assert(merged_clock().get(replica<replicas>(1)) == 2);
+static_assert((merged_clock() <=> static_vector{}) ==
+              std::partial_ordering::greater);
+static_assert(std::is_trivially_copyable_v<static_vector>);
+
+auto main() -> int {
+  using namespace boost::ut;
+  using actor = replica<3>;
+
+  "iteration skips absent replicas"_test = [] {
+    static_map<4> m;
+    m[replica<4>(2)] = 5;
+
+    expect(m.size() == 1_i);
+    expect(m.begin()->first == replica<4>(2));
+    expect(!m.contains(replica<4>(0)));
+
+    m.erase(replica<4>(2));
+    expect(m.empty());
+  };
+
+  "counters run on the fixed clock"_test = [] {
+    gcounter<actor> a, b;
+    a.apply(a + actor(0));
+    b.apply(b + actor(1));
+    b.apply(b + actor(1));
+    a.merge(b);
+
+    expect(a.read() == 3_i);
+
+    pncounter<actor> c;
+    c.merge(c.inc(actor(2), 5));
+    c.merge(c.dec(actor(0), 2));
+    expect(c.read() == 3_i);
+  };
+
+  "sets and registers run on the fixed clock"_test = [] {
+    orswot<std::string, actor> s;
+    s.apply(s.add(s.read().derive_add_context(actor(0)), "a"));
+    s.apply(s.add(s.read().derive_add_context(actor(2)), "b"));
+    s.apply(s.rm(s.contains("a").derive_remove_context(), "a"));
+
+    expect(s.read().value.size() == 1_i);
+    expect(s.read().value.contains("b"));
+
+    mvreg<actor, int> r1, r2;
+    r1.apply(r1.write(r1.read().derive_add_context(actor(0)), 1));
+    r2.apply(r2.write(r2.read().derive_add_context(actor(1)), 2));
+    r1.merge(r2);
+
+    expect(r1.read().value.size() == 2_i);
+  };
+
+  "property based tests"_test = [] {
+    expect(rc::check("merge matches the hash map backend",
+                     [](map<std::uint8_t> dots1, map<std::uint8_t> dots2) {
+                       dots1 = fold(dots1);
+                       dots2 = fold(dots2);
+                       auto s = build<static_vector>(dots1);
+                       auto v = build<hashed_vector>(dots1);
+
+                       s.merge(build<static_vector>(dots2));
+                       v.merge(build<hashed_vector>(dots2));
+
+                       RC_ASSERT(same_dots(s, v));
+                     }));
+
+    expect(rc::check("reset_remove matches the hash map backend",
+                     [](map<std::uint8_t> dots1, map<std::uint8_t> dots2) {
+                       dots1 = fold(dots1);
+                       dots2 = fold(dots2);
+                       auto s = build<static_vector>(dots1);
+                       auto v = build<hashed_vector>(dots1);
+
+                       s.reset_remove(build<static_vector>(dots2));
+                       v.reset_remove(build<hashed_vector>(dots2));
+
+                       RC_ASSERT(same_dots(s, v));
+                     }));
+
+    expect(rc::check("intersection matches the hash map backend",
+                     [](map<std::uint8_t> dots1, map<std::uint8_t> dots2) {
+                       dots1 = fold(dots1);
+                       dots2 = fold(dots2);
+                       auto s = intersection(build<static_vector>(dots1),
+                                             build<static_vector>(dots2));
+                       auto v = intersection(build<hashed_vector>(dots1),
+                                             build<hashed_vector>(dots2));
+
+                       RC_ASSERT(same_dots(s, v));
+                     }));
+
+    expect(rc::check("comparison matches the hash map backend",
+                     [](map<std::uint8_t> dots1, map<std::uint8_t> dots2) {
+                       dots1 = fold(dots1);
+                       dots2 = fold(dots2);
+                       auto s1 = build<static_vector>(dots1);
+                       auto s2 = build<static_vector>(dots2);
+                       auto v1 = build<hashed_vector>(dots1);
+                       auto v2 = build<hashed_vector>(dots2);
+
+                       RC_ASSERT((s1 <=> s2) == (v1 <=> v2));
+                       RC_ASSERT(s1.dominates(s2) == v1.dominates(v2));
+                     }));
+  };
+}
@@ -0,0 +1,81 @@
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/ut.hpp>
+#include <rapidcheck.h>
+
+#include <gcounter.hpp>
+#include <striped_gcounter.hpp>
+
+using counter = crdt::gcounter<std::string>;
+using shared_counter = crdt::striped_gcounter<std::string, 4>;
+
+auto main() -> int {
+  using namespace boost::ut;
+  using namespace crdt;
+
+  "flush folds pending increments into one delta"_test = [] {
+    shared_counter c("A");
+    c.inc();
+    c.inc(4);
+    expect(c.pending() == 5_i);
+    expect(c.read() == 5_i);
+
+    auto delta = c.flush();
+    expect(delta.read() == 5_i);
+    expect(c.pending() == 0_i);
+    expect(c.state().read() == 5_i);
+    expect(c.flush() == counter{});
+  };
+
+  "concurrent increments and flushes replicate every step"_test = [] {
+    shared_counter c("A");
+    std::vector<counter> deltas;
+    {
+      std::vector<std::jthread> writers;
+      for (int w = 0; w < 8; ++w)
+        writers.emplace_back([&c] {
+          for (int i = 0; i < 10000; ++i)
+            c.inc();
+        });
+      for (int f = 0; f < 50; ++f)
+        deltas.push_back(c.flush());
+    }
+    deltas.push_back(c.flush());
+
+    counter replica;
+    for (const auto &delta : deltas)
+      replica.merge(delta);
+    expect(replica.read() == 80000_i);
+    expect(replica == c.state());
+  };
+
+  "merge brings in remote counts"_test = [] {
+    shared_counter c("A");
+    counter remote;
+    remote.inc("B", 3);
+
+    c.inc(2);
+    c.merge(remote);
+    expect(c.read() == 5_i);
+
+    remote.merge(c.flush());
+    expect(remote == c.state());
+  };
+
+  "property based tests"_test = [] {
+    expect(rc::check("matches a plain gcounter",
+                     [](std::vector<std::uint32_t> steps) {
+                       shared_counter c("A");
+                       counter expected;
+                       for (auto s : steps) {
+                         c.inc(s);
+                         expected.inc("A", s);
+                       }
+                       c.flush();
+                       RC_ASSERT(c.read() == expected.read());
+                     }));
+  };
+}
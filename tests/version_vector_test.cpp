@@ -1,3 +1,6 @@
+#include <compare>
+#include <cstdint>
+#include <functional>
 #include <ostream>
 #include <string>
 #include <unordered_map>
@@ -53,6 +56,48 @@ auto main() -> int {
                      RC_ASSERT(v1 == v2);
                    }));
 
+  assert(rc::check("dominates agrees with the partial order",
+                   [](map<int> dots1, map<int> dots2) {
+                     auto v1 = build_vector(std::move(dots1));
+                     auto v2 = build_vector(std::move(dots2));
+
+                     auto cmp = v1 <=> v2;
+                     RC_ASSERT(v1.dominates(v2) == (cmp >= 0));
+                     RC_ASSERT(v2.dominates(v1) == (cmp <= 0));
+                     RC_ASSERT(v1.concurrent_with(v2) ==
+                               (cmp == std::partial_ordering::unordered));
+                   }));
+
+  assert(rc::check("comparison ignores iteration order", [](map<int> dots) {
+    auto v1 = build_vector(map<int>(dots));
+    version_vector<int> v2;
+    v2.dots.reserve(8 * dots.size() + 64);
+    v2.dots.insert(dots.begin(), dots.end());
+
+    RC_ASSERT((v1 <=> v2) == std::partial_ordering::equivalent);
+    RC_ASSERT(v1.dominates(v2) && v2.dominates(v1));
+    RC_ASSERT(std::hash<version_vector<int>>{}(v1) ==
+              std::hash<version_vector<int>>{}(v2));
+  }));
+
+  assert(rc::check("hash covers counters", [](int actor, std::uint64_t counter) {
+    RC_PRE(counter > 0);
+    version_vector<int> v1, v2;
+    v1.apply(dot{actor, counter});
+    v2.apply(dot{actor, counter + 1});
+
+    RC_ASSERT(std::hash<version_vector<int>>{}(v1) !=
+              std::hash<version_vector<int>>{}(v2));
+  }));
+
+  assert(rc::check("hash keeps small clocks apart", [] {
+    auto v1 = build_vector(map<int>{{1, 4}, {2, 1}});
+    auto v2 = build_vector(map<int>{{1, 1}, {2, 2}});
+
+    RC_ASSERT(std::hash<version_vector<int>>{}(v1) !=
+              std::hash<version_vector<int>>{}(v2));
+  }));
+
   assert(rc::check("idempotent", [](map<std::string> dots) {
     auto v = build_vector(std::move(dots));
     auto v_snapshot = build_vector(std::move(dots));
@@ -1,3 +1,5 @@
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <unordered_map>
 
@@ -12,6 +14,31 @@ template <crdt::actor_type A> auto build_vector(map<A> &&counter) {
   return vector;
 }
 
+/// counter as a clock of any backend, e.g. a flat_map, dense_map or
+/// static_map one, each actor converted to the backend's actor type.
+template <typename _Clock, crdt::actor_type A>
+auto build(const map<A> &counter) -> _Clock {
+  _Clock vector;
+  for (const auto &[actor, value] : counter)
+    vector.dots[typename _Clock::actor_t(actor)] = value;
+  return vector;
+}
+
+/// Whether clock, in any backend, holds the same non zero dots as the hash
+/// map backed v.
+template <typename _Clock, crdt::actor_type A>
+auto same_dots(const _Clock &clock, const crdt::version_vector<A> &v) -> bool {
+  std::size_t expected = 0, held = 0;
+  for (const auto &[actor, counter] : v.dots) {
+    if (clock.get(typename _Clock::actor_t(actor)) != counter)
+      return false;
+    expected += counter != 0;
+  }
+  for (const auto &[actor, counter] : clock.dots)
+    held += counter != 0;
+  return expected == held;
+}
+
 namespace crdt {
 template <actor_type A>
 void showValue(const version_vector<A> &v, std::ostream &os) {